@@ -0,0 +1,110 @@
+#include <stdio.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "periodic.h"
+
+static const char *TAG = "PERIODIC";
+
+typedef struct {
+    const periodic_task_t *def;
+    TickType_t             origin;
+    int64_t                origin_us;   /* esp_timer time of the origin tick */
+    TaskHandle_t           task;
+    int64_t                release_us;  /* ideal release of the current job */
+    periodic_stats_t       st;
+} periodic_state_t;
+
+static periodic_state_t g_state[PERIODIC_MAX_TASKS];
+static int g_ntasks = 0;
+
+static void periodic_task(void *arg) {
+    periodic_state_t *s = (periodic_state_t *)arg;
+    const periodic_task_t *d = s->def;
+    const TickType_t period = pdMS_TO_TICKS(d->period_ms);
+    const TickType_t deadline = pdMS_TO_TICKS(d->deadline_ms ? d->deadline_ms : d->period_ms);
+    TickType_t release = s->origin;
+
+    s->task = xTaskGetCurrentTaskHandle();
+
+    /* vTaskDelayUntil() asserts on a zero increment */
+    if (d->phase_ms) vTaskDelayUntil(&release, pdMS_TO_TICKS(d->phase_ms));
+
+    for (;;) {
+        /* Unsigned tick difference: right across the tick count wrap */
+        s->release_us = s->origin_us + (int64_t)(TickType_t)(release - s->origin) * portTICK_PERIOD_MS * 1000;
+        d->body(d->arg);
+
+        TickType_t resp = xTaskGetTickCount() - release;
+        uint32_t resp_ms = (uint32_t)resp * portTICK_PERIOD_MS;
+
+        vTaskSuspendAll();      /* against a reader's snapshot */
+        s->st.jobs++;
+        if (resp > deadline) s->st.misses++;
+        if (resp_ms > s->st.max_resp_ms) s->st.max_resp_ms = resp_ms;
+        xTaskResumeAll();
+
+        vTaskDelayUntil(&release, period);
+    }
+}
+
+int periodic_start(const periodic_task_t *table, int n) {
+    /* Start on a tick edge, so origin_us is where the tick grid lies on
+       the esp_timer clock */
+    vTaskDelay(1);
+    TickType_t origin = xTaskGetTickCount();
+    int64_t origin_us = esp_timer_get_time();
+    int started = 0;
+
+    for (int i = 0; i < n; ++i) {
+        const periodic_task_t *d = &table[i];
+        configASSERT(d->body != NULL && d->period_ms > 0);
+        if (g_ntasks >= PERIODIC_MAX_TASKS) {
+            ESP_LOGE(TAG, "%s: more than %d periodic tasks", d->name, PERIODIC_MAX_TASKS);
+            break;
+        }
+
+        /* Filled in before the task can run: it may preempt us at once */
+        periodic_state_t *s = &g_state[g_ntasks];
+        s->def = d;
+        s->origin = origin;
+        s->origin_us = origin_us;
+        if (xTaskCreate(periodic_task, d->name, d->stack, s, d->prio, NULL) != pdPASS) {
+            ESP_LOGE(TAG, "%s: xTaskCreate failed", d->name);
+            continue;
+        }
+        g_ntasks++;
+        started++;
+    }
+    return started;
+}
+
+int64_t periodic_release_us(void) {
+    TaskHandle_t me = xTaskGetCurrentTaskHandle();
+
+    /* Every slot: a task may run its first job before g_ntasks counts it */
+    for (int i = 0; i < PERIODIC_MAX_TASKS; ++i)
+        if (g_state[i].task == me) return g_state[i].release_us;
+    return -1;
+}
+
+int periodic_get(int i, periodic_stats_t *out) {
+    if (i < 0 || i >= g_ntasks) return 0;
+    vTaskSuspendAll();
+    *out = g_state[i].st;
+    xTaskResumeAll();
+    return 1;
+}
+
+void periodic_report(void) {
+    for (int i = 0; i < g_ntasks; ++i) {
+        const periodic_task_t *d = g_state[i].def;
+        periodic_stats_t st;
+        periodic_get(i, &st);
+        ESP_LOGI(TAG, "%s: T=%u ms phase=%u ms D=%u ms prio=%u jobs=%u misses=%u resp_max=%u ms",
+                 d->name, (unsigned)d->period_ms, (unsigned)d->phase_ms,
+                 (unsigned)(d->deadline_ms ? d->deadline_ms : d->period_ms), (unsigned)d->prio,
+                 (unsigned)st.jobs, (unsigned)st.misses, (unsigned)st.max_resp_ms);
+    }
+}
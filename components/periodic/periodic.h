@@ -0,0 +1,62 @@
+/*
+ * Table-driven periodic tasks for the lab2 projects (shared component: add
+ * ../components or ../../components to EXTRA_COMPONENT_DIRS).
+ *
+ * Each periodic_task_t entry declares one job: its body, period, phase offset
+ * from a common origin, priority, stack and relative deadline.
+ * periodic_start() creates one task per entry. Each task releases its job at
+ * origin + phase + k * period through vTaskDelayUntil(), so releases never
+ * drift and phases stay where the table put them. This generalises lab2_q2's
+ * alternation design: T1 at phase 0 and T2 at phase +1000 ms, both every
+ * 2000 ms.
+ *
+ * The origin is the first tick edge after periodic_start() is called.
+ * Everything is in ticks (pdMS_TO_TICKS of the table's ms), so a job finished
+ * on its deadline tick counts as met. A job that overruns its period makes the next release
+ * late rather than skipping it.
+ */
+
+#ifndef LAB2_PERIODIC_H
+#define LAB2_PERIODIC_H
+
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#ifndef PERIODIC_MAX_TASKS
+#define PERIODIC_MAX_TASKS  32
+#endif
+
+typedef struct {
+    const char  *name;
+    void       (*body)(void *arg);  /* one job: runs to completion each period */
+    void        *arg;
+    uint32_t     period_ms;
+    uint32_t     phase_ms;          /* first release, from the common origin */
+    UBaseType_t  prio;
+    uint32_t     stack;             /* as xTaskCreate's usStackDepth */
+    uint32_t     deadline_ms;       /* relative to each release; 0 = period */
+} periodic_task_t;
+
+typedef struct {
+    uint32_t jobs;                  /* completed */
+    uint32_t misses;                /* finished after release + deadline */
+    uint32_t max_resp_ms;           /* release to finish */
+} periodic_stats_t;
+
+/* Create a task for each of the n entries; the table must outlive them.
+   Returns the number created (n unless out of memory or slots). */
+int  periodic_start(const periodic_task_t *table, int n);
+
+/* From a job body: its ideal release (origin + phase + k * period) in
+   esp_timer_get_time() us, to measure release jitter against; -1 if the
+   caller is not a periodic task */
+int64_t periodic_release_us(void);
+
+/* Counters of the i-th task started so far; 0 if no such task */
+int  periodic_get(int i, periodic_stats_t *out);
+
+/* Log jobs, deadline misses and worst response for every task */
+void periodic_report(void);
+
+#endif /* LAB2_PERIODIC_H */
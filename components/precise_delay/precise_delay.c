@@ -0,0 +1,73 @@
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_timer.h"
+#include "ccount.h"
+#include "precise_delay.h"
+
+#define TICK_US         (portTICK_PERIOD_MS * 1000)
+
+#ifdef LAB2_HOST
+/* lab2_q4 host build (host/sim.c): CCOUNT is simulated time and spinning
+   has to spend it explicitly */
+void sim_spend(uint64_t cycles);
+
+static inline void spin_wait(uint32_t t0, uint32_t cyc) {
+    uint32_t done = ccount_read() - t0;
+    if (done < cyc) sim_spend(cyc - done);
+}
+#else
+static inline void spin_wait(uint32_t t0, uint32_t cyc) {
+    /* Unsigned difference: right across the CCOUNT wrap */
+    while (ccount_read() - t0 < cyc) { }
+}
+#endif
+
+static uint32_t g_exit_cyc = 0;    /* spin exit to caller, from precise_delay_init() */
+
+static void __attribute__((noinline)) spin_cycles(uint32_t t0, uint32_t cyc) {
+    spin_wait(t0, cyc > g_exit_cyc ? cyc - g_exit_cyc : 0);
+}
+
+void precise_delay_init(void) {
+    uint32_t best = UINT32_MAX;
+
+    /* Minimum of a few empty spins: interrupts can only add to one */
+    for (int i = 0; i < 8; ++i) {
+        uint32_t t0 = ccount_read();
+        spin_cycles(t0, 0);
+        uint32_t d = ccount_read() - t0;
+        if (d < best) best = d;
+    }
+    g_exit_cyc = best;
+}
+
+void precise_delay_sleep_until(int64_t deadline_us) {
+    int64_t left = deadline_us - esp_timer_get_time();
+
+    /* vTaskDelay(n) sleeps n - 1 to n ticks: never past left - margin. A wake
+       early in the tick can leave more than a tick, hence the loop. */
+    while (left > TICK_US + PRECISE_DELAY_MARGIN_US) {
+        vTaskDelay((TickType_t)((left - PRECISE_DELAY_MARGIN_US) / TICK_US));
+        left = deadline_us - esp_timer_get_time();
+    }
+}
+
+uint32_t precise_delay_spin_until(int64_t deadline_us) {
+    int64_t left = deadline_us - esp_timer_get_time();
+    if (left <= 0) return (uint32_t)-left;
+
+    spin_cycles(ccount_read(), (uint32_t)left * CCOUNT_PER_US);
+
+    /* An interrupt during the spin can still make it late: measure, not assume */
+    left = deadline_us - esp_timer_get_time();
+    return (left < 0) ? (uint32_t)-left : 0;
+}
+
+uint32_t precise_delay_until(int64_t deadline_us) {
+    precise_delay_sleep_until(deadline_us);
+    return precise_delay_spin_until(deadline_us);
+}
+
+uint32_t precise_delay_us(uint32_t us) {
+    return precise_delay_until(esp_timer_get_time() + us);
+}
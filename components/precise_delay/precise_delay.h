@@ -0,0 +1,43 @@
+/*
+ * Sleep-then-spin delay for the lab2 LED tasks (shared component: each
+ * project adds ../components or ../../components to EXTRA_COMPONENT_DIRS).
+ *
+ * The tasks' "active wait" used to poll xTaskGetTickCount() for 500 ms: the
+ * CPU never reaches lower priorities and the wait is only good to a tick
+ * (10 ms). precise_delay_until() instead blocks in vTaskDelay() until between
+ * PRECISE_DELAY_MARGIN_US and one tick + margin before the deadline, then
+ * spins on CCOUNT for the rest. Everything but that last stretch goes to
+ * lower-priority tasks, and the deadline is met to about a microsecond.
+ *
+ * Deadlines are esp_timer_get_time() microseconds. A task held off past its
+ * deadline by higher-priority work returns late and reports by how much.
+ */
+
+#ifndef LAB2_PRECISE_DELAY_H
+#define LAB2_PRECISE_DELAY_H
+
+#include <stdint.h>
+
+/* Wake-up latency allowed for after the sleep: tick ISR + context switch +
+   whatever runs at equal or higher priority in between */
+#ifndef PRECISE_DELAY_MARGIN_US
+#define PRECISE_DELAY_MARGIN_US 300
+#endif
+
+/* Measure the spin's own exit cost so it can stop that much early; call once
+   before the first delay (uncalibrated it returns a few cycles late) */
+void precise_delay_init(void);
+
+/* Return at deadline_us; the result is how late that was in us (0 = on time) */
+uint32_t precise_delay_until(int64_t deadline_us);
+
+/* Same, us from now */
+uint32_t precise_delay_us(uint32_t us);
+
+/* precise_delay_until() in its two phases, for callers that account for
+   them apart: block until the spin is due, then spin to deadline_us and
+   return how late that was */
+void     precise_delay_sleep_until(int64_t deadline_us);
+uint32_t precise_delay_spin_until(int64_t deadline_us);
+
+#endif /* LAB2_PRECISE_DELAY_H */
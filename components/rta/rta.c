@@ -0,0 +1,128 @@
+#include <stdio.h>
+#include "rta.h"
+
+static uint32_t deadline_of(const rta_task_t *t) {
+    return t->deadline_us ? t->deadline_us : t->period_us;
+}
+
+/* Highest priority of any task that takes lock k */
+static uint32_t ceiling(const rta_task_t *ts, int n, int k) {
+    uint32_t c = 0;
+    for (int j = 0; j < n; ++j)
+        if (ts[j].cs_us[k] && ts[j].prio > c) c = ts[j].prio;
+    return c;
+}
+
+/* Longest time lower-priority tasks can keep ts[i] from running on a lock.
+   PI: only locks with a ceiling at or above it matter (direct or push-through
+   blocking), and each lower task and each lock blocks at most once.
+   No PI: only the locks ts[i] takes itself. */
+static uint32_t blocking(const rta_task_t *ts, int n, int i, rta_protocol_t proto) {
+    uint64_t by_lock = 0, by_task = 0;
+
+    for (int k = 0; k < RTA_MAX_LOCKS; ++k) {
+        int counts = (proto == RTA_PI) ? ceiling(ts, n, k) >= ts[i].prio : ts[i].cs_us[k] != 0;
+        if (!counts) continue;
+        uint32_t worst = 0;
+        for (int j = 0; j < n; ++j)
+            if (ts[j].prio < ts[i].prio && ts[j].cs_us[k] > worst) worst = ts[j].cs_us[k];
+        by_lock += worst;
+    }
+    for (int j = 0; j < n; ++j) {
+        if (ts[j].prio >= ts[i].prio) continue;
+        uint32_t worst = 0;
+        for (int k = 0; k < RTA_MAX_LOCKS; ++k) {
+            int counts = (proto == RTA_PI) ? ceiling(ts, n, k) >= ts[i].prio : ts[i].cs_us[k] != 0;
+            if (counts && ts[j].cs_us[k] > worst) worst = ts[j].cs_us[k];
+        }
+        by_task += worst;
+    }
+    return (uint32_t)(by_lock < by_task ? by_lock : by_task);
+}
+
+/* Can ts[j] delay ts[i] once ts[i] is released? */
+static int interferes(const rta_task_t *ts, int n, int i, int j, rta_protocol_t proto) {
+    if (j == i) return 0;
+    if (ts[j].prio >= ts[i].prio) return 1;
+    if (proto == RTA_PI) return 0;
+
+    /* No PI: ts[j] preempts a lower holder of a lock ts[i] is waiting for */
+    for (int h = 0; h < n; ++h) {
+        if (ts[h].prio >= ts[j].prio) continue;
+        for (int k = 0; k < RTA_MAX_LOCKS; ++k)
+            if (ts[i].cs_us[k] && ts[h].cs_us[k]) return 1;
+    }
+    return 0;
+}
+
+static void response(const rta_task_t *ts, int n, int i, rta_protocol_t proto, rta_result_t *out) {
+    uint64_t d = deadline_of(&ts[i]);
+    uint32_t b = blocking(ts, n, i, proto);
+    uint64_t r = (uint64_t)ts[i].wcet_us + b, prev = 0;
+
+    /* Non-decreasing from C + B: stops at the fixed point or past D */
+    while (r != prev && r <= d) {
+        prev = r;
+        r = (uint64_t)ts[i].wcet_us + b;
+        for (int j = 0; j < n; ++j)
+            if (interferes(ts, n, i, j, proto))
+                r += ((prev + ts[j].period_us - 1) / ts[j].period_us) * ts[j].wcet_us;
+    }
+    out->blocking_us = b;
+    out->response_us = (r > UINT32_MAX) ? UINT32_MAX : (uint32_t)r;
+    out->ok = r <= d;
+}
+
+int rta_analyse(const rta_task_t *ts, int n, rta_protocol_t proto, rta_result_t *out) {
+    int misses = 0;
+
+    for (int i = 0; i < n; ++i) {
+        response(ts, n, i, proto, &out[i]);
+        if (!out[i].ok) misses++;
+    }
+    return misses;
+}
+
+int rta_assign(const rta_task_t *ts, int n, rta_protocol_t proto, uint32_t base,
+               uint32_t *prio_out, uint32_t *stuck) {
+    static rta_task_t work[RTA_MAX_TASKS];     /* keep it off a task's stack */
+    uint8_t done[RTA_MAX_TASKS] = { 0 };
+
+    if (n > RTA_MAX_TASKS) return 0;
+    for (int i = 0; i < n; ++i) work[i] = ts[i];
+
+    for (int level = 0; level < n; ++level) {
+        uint32_t prio = base + (uint32_t)level;
+        int pick = -1;
+
+        /* Everyone unassigned sits above this level; their order does not
+           change the candidate's response time */
+        for (int i = 0; i < n; ++i)
+            work[i].prio = done[i] ? prio_out[i] : prio + 1;
+
+        for (int i = n - 1; i >= 0; --i) {
+            if (done[i]) continue;
+            if (pick >= 0 && deadline_of(&ts[i]) <= deadline_of(&ts[pick])) continue;
+
+            rta_result_t r;
+            work[i].prio = prio;
+            response(work, n, i, proto, &r);
+            work[i].prio = prio + 1;
+            if (r.ok) pick = i;
+        }
+        if (pick < 0) {
+            if (stuck) *stuck = prio;
+            return 0;
+        }
+        prio_out[pick] = prio;
+        done[pick] = 1;
+    }
+    return 1;
+}
+
+int rta_format(char *buf, unsigned size, const rta_task_t *t, const rta_result_t *r) {
+    return snprintf(buf, size, "%-10s T=%u D=%u C=%u B=%u prio=%u R=%s%u us%s",
+                    t->name, (unsigned)t->period_us, (unsigned)deadline_of(t),
+                    (unsigned)t->wcet_us, (unsigned)r->blocking_us, (unsigned)t->prio,
+                    r->ok ? "" : ">", (unsigned)r->response_us, r->ok ? "" : "  DEADLINE MISS");
+}
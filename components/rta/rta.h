@@ -0,0 +1,88 @@
+/*
+ * Fixed-priority response-time analysis for the lab2 task sets (shared
+ * component: add ../components or ../../components to EXTRA_COMPONENT_DIRS).
+ *
+ * A task is its period T, relative deadline D (<= T), worst-case execution
+ * time C, FreeRTOS priority and, for each shared lock, its longest critical
+ * section on it. The worst-case response time is the fixed point of
+ *
+ *     R = C + B + sum over j in I  of  ceil(R / T_j) * C_j
+ *
+ * where I is every other task at the same or a higher priority (equal
+ * priorities time-slice, so they are counted as interference) and B bounds
+ * the time a lower-priority task can hold a lock the task needs:
+ *
+ *   RTA_PI     priority inheritance (FreeRTOS mutexes): each lower task and
+ *              each lock at most once, the smaller of the two sums over the
+ *              locks whose ceiling is at or above the task's priority.
+ *   RTA_NO_PI  binary semaphores: as above for the locks the task itself
+ *              takes, and every task that can preempt the holder while the
+ *              task waits (between the two priorities) is interference too.
+ *
+ * rta_assign() chooses the priorities instead (Audsley's optimal priority
+ * assignment): from the lowest level up, give the level to a task that meets
+ * its deadline with every task still unassigned above it. The test above
+ * depends only on which tasks are above, not their order, so this finds a
+ * feasible assignment whenever one exists.
+ *
+ * rta.c is plain C with no FreeRTOS dependency: the firmware runs it at boot
+ * through rta_admit(), and rta_check.cmake builds it for the host to fail the
+ * build when a deadline can be missed or to generate the PRIO_* constants.
+ */
+
+#ifndef LAB2_RTA_H
+#define LAB2_RTA_H
+
+#include <stdint.h>
+
+#define RTA_MAX_LOCKS   4
+#define RTA_MAX_TASKS   32
+
+/* A task set's priority column: the PRIO_* constant, or 0 while rta_assign
+   (the host tool) is choosing them */
+#ifdef RTA_ASSIGN
+#define RTA_PRIO(name)  0
+#else
+#define RTA_PRIO(name)  (name)
+#endif
+
+typedef enum {
+    RTA_NO_PI,
+    RTA_PI,
+} rta_protocol_t;
+
+typedef struct {
+    const char *name;
+    uint32_t    period_us;
+    uint32_t    deadline_us;            /* 0 = period */
+    uint32_t    wcet_us;
+    uint32_t    prio;                   /* larger runs first */
+    uint32_t    cs_us[RTA_MAX_LOCKS];   /* longest hold of lock k; 0 = never takes it */
+} rta_task_t;
+
+typedef struct {
+    uint32_t blocking_us;
+    uint32_t response_us;               /* first iterate past D when it misses */
+    int      ok;                        /* response_us <= deadline */
+} rta_result_t;
+
+/* Analyse the n tasks into out[0..n-1]; returns how many can miss */
+int rta_analyse(const rta_task_t *ts, int n, rta_protocol_t proto, rta_result_t *out);
+
+/* Assign n distinct priorities base .. base + n - 1 to the tasks, ignoring
+   their prio fields, into prio_out[0..n-1]. Among tasks that fit a level the
+   one with the longest deadline takes it, then the one latest in the table.
+   Returns 1, or 0 if no assignment meets every deadline; then *stuck is the
+   lowest level nobody fits (base + number of levels filled). */
+int rta_assign(const rta_task_t *ts, int n, rta_protocol_t proto, uint32_t base,
+               uint32_t *prio_out, uint32_t *stuck);
+
+/* One report line for task t and its result r, as both the host check and
+   rta_admit() print it */
+int rta_format(char *buf, unsigned size, const rta_task_t *t, const rta_result_t *r);
+
+/* Boot-time admission check (rta_admit.c): analyse, log every task and
+   return 1 if all deadlines hold, 0 otherwise */
+int rta_admit(const rta_task_t *ts, int n, rta_protocol_t proto);
+
+#endif /* LAB2_RTA_H */
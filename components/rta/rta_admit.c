@@ -0,0 +1,25 @@
+#include <stdio.h>
+#include "esp_log.h"
+#include "rta.h"
+
+static const char *TAG = "RTA";
+
+int rta_admit(const rta_task_t *ts, int n, rta_protocol_t proto) {
+    static rta_result_t res[RTA_MAX_TASKS];   /* boot only: keep it off the stack */
+    char line[128];
+
+    if (n > RTA_MAX_TASKS) {
+        ESP_LOGE(TAG, "%d tasks, at most %d", n, RTA_MAX_TASKS);
+        return 0;
+    }
+    int misses = rta_analyse(ts, n, proto, res);
+    for (int i = 0; i < n; ++i) {
+        rta_format(line, sizeof(line), &ts[i], &res[i]);
+        if (res[i].ok) ESP_LOGI(TAG, "%s", line);
+        else           ESP_LOGE(TAG, "%s", line);
+    }
+    if (misses)
+        ESP_LOGE(TAG, "%s: %d of %d tasks can miss their deadline",
+                 proto == RTA_PI ? "PI" : "no PI", misses, n);
+    return misses == 0;
+}
@@ -0,0 +1,54 @@
+/*
+ * Host priority assignment, built and run by rta_check.cmake's rta_assign().
+ *
+ * The task-set header is force-included (-include) with RTA_ASSIGN defined,
+ * so its priority column reads 0 (RTA_PRIO). It must define
+ *   RTA_TASKSET     rta_task_t initialisers, comma separated
+ *   RTA_PROTOCOL    RTA_PI or RTA_NO_PI
+ *   RTA_PRIO_NAMES  the name of each task's priority constant, as strings
+ * and may define RTA_PRIO_BASE (default 1, just above the idle task).
+ * Prints the header of PRIO_* defines on stdout, or exits 1 if no
+ * assignment meets every deadline.
+ */
+
+#include <stdio.h>
+#include "rta.h"
+
+#ifndef RTA_PRIO_BASE
+#define RTA_PRIO_BASE   1
+#endif
+
+static const rta_task_t g_ts[] = { RTA_TASKSET };
+static const char *const g_names[] = { RTA_PRIO_NAMES };
+#define N   ((int)(sizeof(g_ts) / sizeof(g_ts[0])))
+
+int main(int argc, char **argv) {
+    const char *guard = argc > 1 ? argv[1] : "RTA_PRIO_H";
+    uint32_t prio[N], stuck = 0;
+    rta_task_t ts[N];
+    rta_result_t res[N];
+    char line[128];
+
+    if (!rta_assign(g_ts, N, RTA_PROTOCOL, RTA_PRIO_BASE, prio, &stuck)) {
+        fprintf(stderr, "no feasible priority assignment: no task meets its deadline at "
+                        "priority %u with the rest above it\n", (unsigned)stuck);
+        return 1;
+    }
+
+    printf("/* Generated by rta_assign (Audsley's optimal priority assignment) from the\n"
+           "   task set; do not edit. Worst-case response times at these priorities:\n");
+    for (int i = 0; i < N; ++i) {
+        ts[i] = g_ts[i];
+        ts[i].prio = prio[i];
+    }
+    rta_analyse(ts, N, RTA_PROTOCOL, res);
+    for (int i = 0; i < N; ++i) {
+        rta_format(line, sizeof(line), &ts[i], &res[i]);
+        printf("     %s\n", line);
+    }
+    printf("*/\n\n#ifndef %s\n#define %s\n\n", guard, guard);
+    for (int i = 0; i < N; ++i)
+        printf("#define %-20s %u\n", g_names[i], (unsigned)prio[i]);
+    printf("\n#endif /* %s */\n", guard);
+    return 0;
+}
@@ -0,0 +1,28 @@
+/*
+ * Host build-time schedulability check, built and run by rta_check.cmake.
+ *
+ * The task-set header is force-included (-include) and must define
+ *   RTA_TASKSET   rta_task_t initialisers, comma separated
+ *   RTA_PROTOCOL  RTA_PI or RTA_NO_PI
+ * Exit status 1 if any deadline can be missed.
+ */
+
+#include <stdio.h>
+#include "rta.h"
+
+static const rta_task_t g_ts[] = { RTA_TASKSET };
+#define N   ((int)(sizeof(g_ts) / sizeof(g_ts[0])))
+
+int main(void) {
+    rta_result_t res[N];
+    char line[128];
+
+    int misses = rta_analyse(g_ts, N, RTA_PROTOCOL, res);
+    for (int i = 0; i < N; ++i) {
+        rta_format(line, sizeof(line), &g_ts[i], &res[i]);
+        printf("%s\n", line);
+    }
+    if (misses)
+        printf("%d of %d tasks can miss their deadline\n", misses, N);
+    return misses ? 1 : 0;
+}
@@ -0,0 +1,77 @@
+# Build-time response-time analysis of a project's task set.
+#
+#   include(<...>/components/rta/rta_check.cmake)
+#   rta_assign(${CMAKE_CURRENT_LIST_DIR}/main/taskset.h ${CMAKE_CURRENT_LIST_DIR}/main/taskset_prio.h)
+#   rta_check(${CMAKE_CURRENT_LIST_DIR}/main/taskset.h)
+#
+# Both build rta.c and a driver with the host compiler at configure time and
+# run it on the header (see the driver for what it must define); editing the
+# header re-runs the configure step.
+#   rta_assign  rta_assign.c: chooses the priorities and rewrites the PRIO_*
+#               header when they change; stops if no assignment is feasible
+#   rta_check   rta_check.c: stops the configure, hence the build, if a
+#               deadline can be missed at the priorities the firmware uses
+
+set(RTA_DIR ${CMAKE_CURRENT_LIST_DIR})
+
+# Build ${RTA_DIR}/<driver>.c for taskset_h into ${CMAKE_BINARY_DIR}/<driver>;
+# sets ${exe_var} to it, or to "" when there is no host compiler
+function(rta_host_build driver taskset_h exe_var)
+    find_program(RTA_HOST_CC NAMES cc gcc clang)
+    if(NOT RTA_HOST_CC)
+        message(WARNING "${driver}: no host C compiler, ${taskset_h} not analysed")
+        set(${exe_var} "" PARENT_SCOPE)
+        return()
+    endif()
+    set_property(DIRECTORY APPEND PROPERTY CMAKE_CONFIGURE_DEPENDS
+                 ${taskset_h} ${RTA_DIR}/rta.c ${RTA_DIR}/rta.h ${RTA_DIR}/${driver}.c)
+
+    get_filename_component(inc ${taskset_h} DIRECTORY)
+    set(exe ${CMAKE_BINARY_DIR}/${driver})
+    execute_process(COMMAND ${RTA_HOST_CC} -std=gnu99 -O2 ${ARGN} -I${RTA_DIR} -I${inc}
+                            -include ${taskset_h} -o ${exe}
+                            ${RTA_DIR}/rta.c ${RTA_DIR}/${driver}.c
+                    RESULT_VARIABLE rc ERROR_VARIABLE err)
+    if(NOT rc EQUAL 0)
+        message(FATAL_ERROR "${driver}: cannot build the analyser for ${taskset_h}:\n${err}")
+    endif()
+    set(${exe_var} ${exe} PARENT_SCOPE)
+endfunction()
+
+function(rta_assign taskset_h prio_h)
+    rta_host_build(rta_assign ${taskset_h} exe -DRTA_ASSIGN)
+    if(NOT exe)
+        return()
+    endif()
+
+    get_filename_component(name ${prio_h} NAME_WE)
+    string(TOUPPER "LAB2_${name}_H" guard)
+    execute_process(COMMAND ${exe} ${guard} RESULT_VARIABLE rc
+                    OUTPUT_VARIABLE out ERROR_VARIABLE err)
+    if(NOT rc EQUAL 0)
+        message(FATAL_ERROR "rta_assign: ${taskset_h}: ${err}")
+    endif()
+
+    # Rewrite only on a change: the firmware sources include it
+    set(old "")
+    if(EXISTS ${prio_h})
+        file(READ ${prio_h} old)
+    endif()
+    if(NOT old STREQUAL out)
+        file(WRITE ${prio_h} "${out}")
+        message(STATUS "rta_assign: new priorities in ${prio_h}")
+    endif()
+endfunction()
+
+function(rta_check taskset_h)
+    rta_host_build(rta_check ${taskset_h} exe)
+    if(NOT exe)
+        return()
+    endif()
+
+    execute_process(COMMAND ${exe} RESULT_VARIABLE rc OUTPUT_VARIABLE out)
+    if(NOT rc EQUAL 0)
+        message(FATAL_ERROR "rta_check: ${taskset_h} is not schedulable:\n${out}")
+    endif()
+    message(STATUS "rta_check: ${taskset_h}\n${out}")
+endfunction()
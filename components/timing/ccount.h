@@ -0,0 +1,28 @@
+/*
+ * CPU cycle counter for the lab2 timing components (shared, header-only:
+ * add ../components or ../../components to EXTRA_COMPONENT_DIRS).
+ *
+ * CCOUNT runs at configCPU_CLOCK_HZ and wraps every ~53 s at 80 MHz, so only
+ * the unsigned difference of two reads is meaningful. In the lab2_q4 host
+ * build (LAB2_HOST) it is host/sim.c's simulated time instead.
+ */
+
+#ifndef LAB2_CCOUNT_H
+#define LAB2_CCOUNT_H
+
+#include <stdint.h>
+
+#define CCOUNT_PER_US   (configCPU_CLOCK_HZ / 1000000)
+
+#ifdef LAB2_HOST
+uint32_t timebase_ccount(void);     /* host/sim.c */
+static inline uint32_t ccount_read(void) { return timebase_ccount(); }
+#else
+static inline uint32_t ccount_read(void) {
+    uint32_t c;
+    __asm__ __volatile__("rsr %0, ccount" : "=a"(c));
+    return c;
+}
+#endif
+
+#endif /* LAB2_CCOUNT_H */
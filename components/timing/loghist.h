@@ -0,0 +1,37 @@
+/*
+ * Log-linear histogram buckets for the lab2 timing components (shared,
+ * header-only: add ../components or ../../components to EXTRA_COMPONENT_DIRS).
+ *
+ * Values 0..15 get a bucket each, then every power of two is split into 8
+ * (within 12.5%), up to 2^20 - 1; larger values clamp into the last bucket.
+ * The caller keeps the counts: an array of LOGHIST_BUCKETS of any width.
+ */
+
+#ifndef LAB2_LOGHIST_H
+#define LAB2_LOGHIST_H
+
+#include <stdint.h>
+
+#define LOGHIST_BUCKETS     (16 + 16 * 8)   /* 0 .. 2^20-1 */
+
+static inline int loghist_bucket(uint32_t v) {
+    if (v < 16) return (int)v;
+    int e = 31 - __builtin_clz(v);
+    if (e >= 20) return LOGHIST_BUCKETS - 1;
+    return 16 + (e - 4) * 8 + (int)((v >> (e - 3)) & 7);
+}
+
+/* Smallest / largest value bucket b holds */
+static inline uint32_t loghist_lo(int b) {
+    if (b < 16) return (uint32_t)b;
+    int e = (b - 16) / 8 + 4, m = (b - 16) % 8;
+    return (uint32_t)(8 + m) << (e - 3);
+}
+
+static inline uint32_t loghist_hi(int b) {
+    if (b < 16) return (uint32_t)b;
+    int e = (b - 16) / 8 + 4, m = (b - 16) % 8;
+    return ((uint32_t)(8 + m + 1) << (e - 3)) - 1;
+}
+
+#endif /* LAB2_LOGHIST_H */
@@ -0,0 +1,164 @@
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "ccount.h"
+#include "wcet.h"
+
+static const char *TAG = "WCET";
+
+typedef struct {
+    const char   *name;
+    TaskHandle_t  task;
+    uint64_t      run_cyc;          /* on the CPU so far, up to the last switch */
+    uint64_t      begin_cyc;        /* wcet_now() at wcet_begin() */
+    uint32_t      n;
+    uint32_t      min_us, max_us;
+    uint64_t      sum_us;
+    uint16_t      hist[WCET_BUCKETS];   /* saturating counts */
+} wcet_task_t;
+
+static wcet_task_t g_tasks[WCET_MAX_TASKS];
+static int g_ntasks = 0;
+
+/* Upper end of the bucket holding the permille/10-th percentile, max-capped;
+   max itself in the last bucket, which has no upper end */
+static uint32_t hist_pct(const wcet_task_t *t, unsigned permille) {
+    uint32_t total = 0, seen = 0;
+    for (int b = 0; b < WCET_BUCKETS; ++b) total += t->hist[b];
+    if (total == 0) return 0;
+
+    uint32_t want = (uint32_t)(((uint64_t)total * permille + 999) / 1000);
+    for (int b = 0; b < WCET_BUCKETS - 1; ++b) {
+        seen += t->hist[b];
+        if (seen >= want) return loghist_hi(b) < t->max_us ? loghist_hi(b) : t->max_us;
+    }
+    return t->max_us;
+}
+
+#if WCET_ENABLE
+
+static int      g_running = -1;     /* slot of the task on the CPU, -1 if none */
+static uint32_t g_in_cyc;           /* ccount_read() when it got there */
+
+static int slot_of(TaskHandle_t h) {
+    for (int i = 0; i < g_ntasks; ++i)
+        if (g_tasks[i].task == h) return i;
+    return -1;
+}
+
+void wcet_switched_in(void) {
+    uint32_t now = ccount_read();
+
+    /* Unsigned difference: right across the CCOUNT wrap (53 s at 80 MHz) */
+    if (g_running >= 0) g_tasks[g_running].run_cyc += now - g_in_cyc;
+    g_running = slot_of(xTaskGetCurrentTaskHandle());
+    g_in_cyc = now;
+}
+
+/* Cycles the calling task (slot id) has been on the CPU, including this run */
+static uint64_t wcet_now(int id) {
+    uint64_t c;
+    taskENTER_CRITICAL();
+    c = g_tasks[id].run_cyc + (uint32_t)(ccount_read() - g_in_cyc);
+    taskEXIT_CRITICAL();
+    return c;
+}
+
+int wcet_register(const char *name) {
+    int id = -1;
+    taskENTER_CRITICAL();
+    if (g_ntasks < WCET_MAX_TASKS) {
+        id = g_ntasks;
+        memset(&g_tasks[id], 0, sizeof(g_tasks[0]));
+        g_tasks[id].name = name;
+        g_tasks[id].task = xTaskGetCurrentTaskHandle();
+        g_ntasks++;
+        g_running = id;             /* we are on the CPU: the hook missed us */
+        g_in_cyc = ccount_read();
+    }
+    taskEXIT_CRITICAL();
+    return id;
+}
+
+void wcet_begin(int id) {
+    if (id < 0) return;
+    g_tasks[id].begin_cyc = wcet_now(id);
+}
+
+void wcet_end(int id) {
+    if (id < 0) return;
+    wcet_task_t *t = &g_tasks[id];
+    uint32_t us = (uint32_t)((wcet_now(id) - t->begin_cyc) / CCOUNT_PER_US);
+
+    taskENTER_CRITICAL();   /* against a reader's snapshot */
+    if (t->n == 0 || us < t->min_us) t->min_us = us;
+    if (us > t->max_us) t->max_us = us;
+    t->n++;
+    t->sum_us += us;
+    uint16_t *c = &t->hist[loghist_bucket(us)];
+    if (*c != UINT16_MAX) (*c)++;
+    taskEXIT_CRITICAL();
+}
+
+#endif /* WCET_ENABLE */
+
+/* Interrupts off: wcet_end() and the switch hook both write a slot */
+static void snapshot(int id, wcet_task_t *out) {
+    taskENTER_CRITICAL();
+    *out = g_tasks[id];
+    taskEXIT_CRITICAL();
+}
+
+static void stats_of(const wcet_task_t *t, wcet_stats_t *out) {
+    out->n       = t->n;
+    out->min_us  = t->min_us;
+    out->max_us  = t->max_us;
+    out->mean_us = t->n ? (uint32_t)(t->sum_us / t->n) : 0;
+    out->p50_us  = hist_pct(t, 500);
+    out->p90_us  = hist_pct(t, 900);
+    out->p99_us  = hist_pct(t, 990);
+    out->p999_us = hist_pct(t, 999);
+}
+
+int wcet_get(int id, wcet_stats_t *out) {
+    if (id < 0 || id >= g_ntasks) return 0;
+
+    /* Straight from the live slot, under the same lock as snapshot(): no
+       copy of the histogram, so concurrent callers share nothing */
+    taskENTER_CRITICAL();
+    stats_of(&g_tasks[id], out);
+    taskEXIT_CRITICAL();
+    return 1;
+}
+
+void wcet_report(void) {
+    static wcet_task_t snap;
+    static wcet_stats_t s;
+
+    for (int i = 0; i < g_ntasks; ++i) {
+        snapshot(i, &snap);
+        stats_of(&snap, &s);
+        if (s.n == 0) continue;
+        ESP_LOGI(TAG, "%s: n=%u min=%u mean=%u p50<=%u p90<=%u p99<=%u p99.9<=%u max=%u us",
+                 snap.name, (unsigned)s.n, (unsigned)s.min_us, (unsigned)s.mean_us,
+                 (unsigned)s.p50_us, (unsigned)s.p90_us, (unsigned)s.p99_us,
+                 (unsigned)s.p999_us, (unsigned)s.max_us);
+
+        /* For the analysis tools: grep -o 'WCETJSON:.*' log | cut -c10- */
+        printf("WCETJSON:{\"task\":\"%s\",\"n\":%u,\"min_us\":%u,\"mean_us\":%u,\"p50_us\":%u,"
+               "\"p90_us\":%u,\"p99_us\":%u,\"p999_us\":%u,\"wcet_us\":%u,\"hist\":[",
+               snap.name, (unsigned)s.n, (unsigned)s.min_us, (unsigned)s.mean_us,
+               (unsigned)s.p50_us, (unsigned)s.p90_us, (unsigned)s.p99_us,
+               (unsigned)s.p999_us, (unsigned)s.max_us);
+        const char *sep = "";
+        for (int b = 0; b < WCET_BUCKETS; ++b) {
+            if (!snap.hist[b]) continue;
+            printf("%s[%u,%u,%u]", sep, (unsigned)loghist_lo(b), (unsigned)loghist_hi(b),
+                   (unsigned)snap.hist[b]);
+            sep = ",";
+        }
+        printf("]}\n");
+    }
+}
@@ -0,0 +1,68 @@
+/*
+ * Execution-time measurement of task loop bodies (WCET_ENABLE, seen through
+ * the project's FreeRTOSConfig.h, which its CMakeLists.txt must put on the
+ * build-wide include path; shared component: add ../components or
+ * ../../components to EXTRA_COMPONENT_DIRS).
+ *
+ * A task loop calls wcet_begin(id) / wcet_end(id) around one iteration. What
+ * is kept is the CCOUNT cycles the task itself was on the CPU in between: the
+ * switch-in hook (wcet_switched_in) charges each run to the task leaving the
+ * CPU, so time blocked or preempted is left out. Interrupts taken while the
+ * task runs are not: they are part of what it costs on this core.
+ *
+ * Each iteration goes into a log-linear histogram in us (exact below 16 us,
+ * then 8 buckets per power of two, within 12.5%, up to ~1 s), so percentiles
+ * need no sample storage and are upper bounds; n, min, max and mean are exact.
+ * wcet_report() logs them and exports one WCETJSON line per task for the
+ * analysis tools (components/rta: the wcet column of a task set):
+ *
+ *   grep -o 'WCETJSON:.*' serial.log | cut -c10- > wcet.jsonl
+ *
+ * A maximum only covers the paths a task has taken: run long enough for
+ * every branch (and the periodic reports) to happen.
+ */
+
+#ifndef LAB2_WCET_H
+#define LAB2_WCET_H
+
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "loghist.h"
+
+#define WCET_MAX_TASKS  8
+#define WCET_BUCKETS    LOGHIST_BUCKETS     /* 0 .. 2^20-1 us */
+
+typedef struct {
+    uint32_t n;
+    uint32_t min_us;
+    uint32_t max_us;
+    uint32_t mean_us;
+    uint32_t p50_us;
+    uint32_t p90_us;
+    uint32_t p99_us;
+    uint32_t p999_us;
+} wcet_stats_t;
+
+#if WCET_ENABLE
+/* From the task itself, before its loop: returns its id, -1 if full */
+int  wcet_register(const char *name);
+
+/* From the task itself: one iteration starts / ends */
+void wcet_begin(int id);
+void wcet_end(int id);
+
+/* traceTASK_SWITCHED_IN: the new task is already current */
+void wcet_switched_in(void);
+#else
+#define wcet_register(name)     (-1)
+#define wcet_begin(id)          ((void)(id))
+#define wcet_end(id)            ((void)(id))
+#endif
+
+/* Snapshot of one task's statistics; 0 if no such id */
+int  wcet_get(int id, wcet_stats_t *out);
+
+/* Log every task's statistics, then its WCETJSON line */
+void wcet_report(void);
+
+#endif /* LAB2_WCET_H */
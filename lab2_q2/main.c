@@ -1,9 +1,15 @@
 #include <stdio.h>
+#include <string.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "semphr.h"
 #include "driver/gpio.h"
 #include "esp_log.h"
+#include "esp_timer.h"
+#include "jitter.h"
+#include "periodic.h"
+#include "taskset.h"
+#include "wcet.h"
 
 #ifndef LED_PIN
 #define LED_PIN 2
@@ -11,11 +17,9 @@
 
 static const char *TAG = "lab2";
 
-static const int PRIO_TASK1_LED_ON   = 3;
-static const int PRIO_TASK2_LED_OFF  = 2;
-static const int PRIO_TASK3_STATUS   = 1;
-
 static SemaphoreHandle_t g_ledMutex;
+static int g_jit_on, g_jit_off;     /* jitter.c ids */
+static int g_wc_on = -1, g_wc_off = -1, g_wc_uart = -1;    /* wcet.c ids */
 
 static void led_init(void) {
     gpio_config_t io = {0};
@@ -31,61 +35,83 @@ static inline void led_off(void) { gpio_set_level(LED_PIN, 0); }
    - T1 (prio 3): every 2000 ms at phase 0, sets LED ON.
    - T2 (prio 2): every 2000 ms at phase +1000 ms, sets LED OFF.
    Result: ON 1 s, OFF 1 s, repeat.
+   Each is one job of the periodic task table below; periodic.c releases it.
+   With WCET_ENABLE each job is timed, registering on its first run (the
+   periodic task is current only from there); see taskset.h.
 */
 
-static void task_led_on_busywait(void *arg) {
+static void job_led_on(void *arg) {
     (void)arg;
-    const TickType_t period2s = pdMS_TO_TICKS(2000);
-    TickType_t next = xTaskGetTickCount();
-
-    for (;;) {
-        TickType_t req = xTaskGetTickCount();
-        xSemaphoreTake(g_ledMutex, portMAX_DELAY);
-        TickType_t got = xTaskGetTickCount();
-
-        ESP_LOGI(TAG, "T1: took LED mutex (wait=%lu ms)",
-                 (unsigned long)((got - req) * portTICK_PERIOD_MS));
-
-        led_on();
-        ESP_LOGI(TAG, "T1: LED ON (1s window)");
-
-        xSemaphoreGive(g_ledMutex);
-        vTaskDelayUntil(&next, period2s);
-    }
+    if (g_wc_on < 0) g_wc_on = wcet_register("tLED_ON");
+    wcet_begin(g_wc_on);
+    jitter_release(g_jit_on, periodic_release_us());
+    int64_t req = esp_timer_get_time();
+    xSemaphoreTake(g_ledMutex, portMAX_DELAY);
+    int64_t got = esp_timer_get_time();
+
+    ESP_LOGI(TAG, "T1: took LED mutex (wait=%lu us)",
+             (unsigned long)(got - req));
+
+    led_on();
+    jitter_done(g_jit_on);      /* LED edge */
+    ESP_LOGI(TAG, "T1: LED ON (1s window)");
+
+    xSemaphoreGive(g_ledMutex);
+    wcet_end(g_wc_on);
 }
 
-static void task_led_off_delay(void *arg) {
+static void job_led_off(void *arg) {
     (void)arg;
-    const TickType_t period2s = pdMS_TO_TICKS(2000);
-
-    vTaskDelay(pdMS_TO_TICKS(1000));  /* phase offset +1s */
-    TickType_t next = xTaskGetTickCount();
+    if (g_wc_off < 0) g_wc_off = wcet_register("tLED_OFF");
+    wcet_begin(g_wc_off);
+    jitter_release(g_jit_off, periodic_release_us());
+    int64_t req = esp_timer_get_time();
+    xSemaphoreTake(g_ledMutex, portMAX_DELAY);
+    int64_t got = esp_timer_get_time();
+
+    ESP_LOGI(TAG, "T2: took LED mutex (wait=%lu us)",
+             (unsigned long)(got - req));
+
+    led_off();
+    jitter_done(g_jit_off);     /* LED edge */
+    ESP_LOGI(TAG, "T2: LED OFF (1s window)");
+
+    xSemaphoreGive(g_ledMutex);
+    wcet_end(g_wc_off);
+}
 
-    for (;;) {
-        TickType_t req = xTaskGetTickCount();
-        xSemaphoreTake(g_ledMutex, portMAX_DELAY);
-        TickType_t got = xTaskGetTickCount();
+static void job_status_uart(void *arg) {
+    (void)arg;
+    static uint32_t n = 0;
+
+    if (g_wc_uart < 0) g_wc_uart = wcet_register("tUART");
+    wcet_begin(g_wc_uart);
+    ESP_LOGI(TAG, "T3: status ticks=%lu",
+             (unsigned long)xTaskGetTickCount());
+    if (++n % 10 == 0) {        /* every 10 s */
+        jitter_report();
+        periodic_report();
+    }
+    wcet_end(g_wc_uart);
 
-        ESP_LOGI(TAG, "T2: took LED mutex (wait=%lu ms)",
-                 (unsigned long)((got - req) * portTICK_PERIOD_MS));
+    /* Outside the timed job: only WCET_ENABLE builds have it to print */
+    if (n % 10 == 0) wcet_report();
+}
 
-        led_off();
-        ESP_LOGI(TAG, "T2: LED OFF (1s window)");
+/* ===== Task set (taskset.h) ===== */
 
-        xSemaphoreGive(g_ledMutex);
-        vTaskDelayUntil(&next, period2s);
-    }
-}
+#define PERIODIC_TASK(name, body, period, phase, deadline, prio, stack, wcet, led_cs) \
+    { name, body, NULL, period, phase, prio, stack, deadline },
 
-static void task_status_uart(void *arg) {
-    (void)arg;
-    const TickType_t one_sec = pdMS_TO_TICKS(1000);
+static const periodic_task_t k_tasks[] = { LAB2_TASKSET(PERIODIC_TASK) };
+static const rta_task_t k_rta[] = { RTA_TASKSET };
 
-    for (;;) {
-        ESP_LOGI(TAG, "T3: status ticks=%lu",
-                 (unsigned long)xTaskGetTickCount());
-        vTaskDelay(one_sec);
-    }
+/* Period of a table entry in us, for jitter.c: 0 if not in the table */
+static uint32_t task_period_us(const char *name) {
+    for (size_t i = 0; i < sizeof(k_tasks) / sizeof(k_tasks[0]); i++)
+        if (strcmp(k_tasks[i].name, name) == 0)
+            return k_tasks[i].period_ms * 1000u;
+    return 0;
 }
 
 void app_main(void) {
@@ -94,8 +120,13 @@ void app_main(void) {
 
     g_ledMutex = xSemaphoreCreateMutex();
     configASSERT(g_ledMutex != NULL);
+    g_jit_on  = jitter_register("tLED_ON",  task_period_us("tLED_ON"));
+    g_jit_off = jitter_register("tLED_OFF", task_period_us("tLED_OFF"));
 
-    xTaskCreate(task_led_on_busywait, "tLED_ON",  1024, NULL, PRIO_TASK1_LED_ON,  NULL);
-    xTaskCreate(task_led_off_delay,   "tLED_OFF", 1024, NULL, PRIO_TASK2_LED_OFF, NULL);
-    xTaskCreate(task_status_uart,     "tUART",    1024, NULL, PRIO_TASK3_STATUS,  NULL);
+    /* Admission check: refuse to start a task set that can miss a deadline */
+    if (!rta_admit(k_rta, sizeof(k_rta) / sizeof(k_rta[0]), RTA_PROTOCOL)) {
+        ESP_LOGE(TAG, "app_main: task set not schedulable, not starting it");
+        return;
+    }
+    periodic_start(k_tasks, sizeof(k_tasks) / sizeof(k_tasks[0]));
 }
@@ -4,6 +4,7 @@
 #include "semphr.h"
 #include "driver/gpio.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 
 #ifndef LED_PIN
 #define LED_PIN 2
@@ -32,11 +33,11 @@ static void task_led_on(void *arg) {
     (void)arg;
     const TickType_t half_sec = pdMS_TO_TICKS(500);
     for (;;) {
-        TickType_t req = xTaskGetTickCount();
+        int64_t req = esp_timer_get_time();
         xSemaphoreTake(g_ledMutex, portMAX_DELAY);
-        TickType_t got = xTaskGetTickCount();
-        ESP_LOGI(TAG, "T1: took LED mutex (wait=%lu ms)",
-                 (unsigned long)((got - req) * portTICK_PERIOD_MS));
+        int64_t got = esp_timer_get_time();
+        ESP_LOGI(TAG, "T1: took LED mutex (wait=%lu us)",
+                 (unsigned long)(got - req));
 
         led_on();
         ESP_LOGI(TAG, "T1: LED ON (busy-wait 500 ms)");
@@ -58,11 +59,11 @@ static void task_led_off(void *arg) {
     (void)arg;
     const TickType_t one_sec = pdMS_TO_TICKS(1000);
     for (;;) {
-        TickType_t req = xTaskGetTickCount();
+        int64_t req = esp_timer_get_time();
         xSemaphoreTake(g_ledMutex, portMAX_DELAY);
-        TickType_t got = xTaskGetTickCount();
-        ESP_LOGI(TAG, "T2: took LED mutex (wait=%lu ms)",
-                 (unsigned long)((got - req) * portTICK_PERIOD_MS));
+        int64_t got = esp_timer_get_time();
+        ESP_LOGI(TAG, "T2: took LED mutex (wait=%lu us)",
+                 (unsigned long)(got - req));
 
         led_off();
         ESP_LOGI(TAG, "T2: LED OFF (delay 1000 ms)");
@@ -0,0 +1,121 @@
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "jitter.h"
+
+static const char *TAG = "JITTER";
+
+typedef struct {
+    uint32_t n;
+    int32_t  min, max;
+    int64_t  sum;
+    uint16_t pos[JITTER_BUCKETS];       /* saturating counts, by magnitude */
+} jitter_hist_t;
+
+typedef struct {
+    const char   *name;
+    uint32_t      period_us;
+    int64_t       release_us;           /* ideal release of the current job */
+    jitter_hist_t late, resp;
+    uint16_t      late_neg[JITTER_BUCKETS];   /* releases ahead of the ideal */
+} jitter_task_t;
+
+static jitter_task_t g_tasks[JITTER_MAX_TASKS];
+static int g_ntasks = 0;
+
+static void hist_add(jitter_hist_t *h, uint16_t *neg, int32_t v) {
+    if (h->n == 0 || v < h->min) h->min = v;
+    if (h->n == 0 || v > h->max) h->max = v;
+    h->n++;
+    h->sum += v;
+
+    uint16_t *c = (v < 0) ? &neg[loghist_bucket((uint32_t)-v)] : &h->pos[loghist_bucket((uint32_t)v)];
+    if (*c != UINT16_MAX) (*c)++;
+}
+
+/* Walk the buckets from most negative to most positive; the answer is the
+   upper end of the bucket holding the pct-th percentile, capped at max. The
+   last positive bucket has no upper end: there it is max */
+static int32_t hist_pct(const jitter_hist_t *h, const uint16_t *neg, unsigned pct) {
+    uint32_t total = 0, seen = 0;
+    for (int b = 0; b < JITTER_BUCKETS; ++b) total += h->pos[b] + (neg ? neg[b] : 0);
+    if (total == 0) return 0;
+
+    uint32_t want = (uint32_t)(((uint64_t)total * pct + 99) / 100);
+    int32_t v = h->max;
+    int b = JITTER_BUCKETS - 1;
+    for (; neg && b >= 0; --b) {
+        seen += neg[b];
+        if (seen >= want) break;
+    }
+    if (neg && b >= 0) {
+        v = -(int32_t)loghist_lo(b);
+    } else {
+        for (b = 0; b < JITTER_BUCKETS - 1; ++b) {
+            seen += h->pos[b];
+            if (seen >= want) { v = (int32_t)loghist_hi(b); break; }
+        }
+    }
+    return (v < h->max) ? v : h->max;
+}
+
+static void hist_stats(const jitter_hist_t *h, const uint16_t *neg, jitter_stats_t *out) {
+    out->n       = h->n;
+    out->min_us  = h->min;
+    out->max_us  = h->max;
+    out->mean_us = h->n ? (int32_t)(h->sum / (int64_t)h->n) : 0;
+    out->p99_us  = hist_pct(h, neg, 99);
+}
+
+static int32_t clamp_us(int64_t v) {
+    return (v > INT32_MAX) ? INT32_MAX : (v < -INT32_MAX) ? -INT32_MAX : (int32_t)v;
+}
+
+int jitter_register(const char *name, uint32_t period_us) {
+    if (g_ntasks >= JITTER_MAX_TASKS) return -1;
+    jitter_task_t *t = &g_tasks[g_ntasks];
+    memset(t, 0, sizeof(*t));
+    t->name = name;
+    t->period_us = period_us;
+    return g_ntasks++;
+}
+
+void jitter_release(int id, int64_t ideal_us) {
+    jitter_task_t *t = &g_tasks[id];
+    hist_add(&t->late, t->late_neg, clamp_us(esp_timer_get_time() - ideal_us));
+    t->release_us = ideal_us;
+}
+
+void jitter_done(int id) {
+    jitter_task_t *t = &g_tasks[id];
+    hist_add(&t->resp, NULL, clamp_us(esp_timer_get_time() - t->release_us));
+}
+
+int jitter_get(int id, jitter_stats_t *release, jitter_stats_t *response) {
+    if (id < 0 || id >= g_ntasks) return 0;
+    jitter_task_t *t = &g_tasks[id];
+
+    /* Only tasks write these: with the scheduler suspended none is mid-update */
+    vTaskSuspendAll();
+    hist_stats(&t->late, t->late_neg, release);
+    hist_stats(&t->resp, NULL, response);
+    xTaskResumeAll();
+    return 1;
+}
+
+void jitter_report(void) {
+    for (int i = 0; i < g_ntasks; ++i) {
+        jitter_stats_t rel, resp;
+        jitter_get(i, &rel, &resp);
+        if (rel.n == 0) continue;
+        ESP_LOGI(TAG, "%s: period %u us, release late n=%u min=%d mean=%d p99<=%d max=%d us",
+                 g_tasks[i].name, (unsigned)g_tasks[i].period_us, (unsigned)rel.n,
+                 (int)rel.min_us, (int)rel.mean_us, (int)rel.p99_us, (int)rel.max_us);
+        ESP_LOGI(TAG, "%s: response n=%u min=%d mean=%d p99<=%d max=%d us",
+                 g_tasks[i].name, (unsigned)resp.n, (int)resp.min_us, (int)resp.mean_us,
+                 (int)resp.p99_us, (int)resp.max_us);
+    }
+}
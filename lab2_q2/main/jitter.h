@@ -0,0 +1,46 @@
+/*
+ * Release jitter and response time of periodic (vTaskDelayUntil) tasks.
+ *
+ * A task calls jitter_release() each time its job starts, with the ideal
+ * release time it was scheduled for (periodic_release_us(): origin + phase +
+ * k * period), and jitter_done() once the job's output is out (the LED
+ * edge). Release lateness is start minus ideal release, response time is
+ * ideal release to done, so a late start counts against both. Times are
+ * esp_timer_get_time() us.
+ *
+ * Both go into log-linear histograms: exact below 16 us, then 8 buckets per
+ * power of two (within 12.5%) up to ~1 s. p99 therefore needs no sample
+ * storage and is an upper bound; n, min, max and mean are exact.
+ */
+
+#ifndef LAB2_JITTER_H
+#define LAB2_JITTER_H
+
+#include <stdint.h>
+#include "loghist.h"
+
+#define JITTER_MAX_TASKS    4
+#define JITTER_BUCKETS      LOGHIST_BUCKETS     /* magnitudes 0 .. 2^20-1 us */
+
+typedef struct {
+    uint32_t n;
+    int32_t  min_us;
+    int32_t  max_us;
+    int32_t  mean_us;
+    int32_t  p99_us;
+} jitter_stats_t;
+
+/* Watch a periodic task; returns its id for the calls below, -1 if full */
+int jitter_register(const char *name, uint32_t period_us);
+
+/* From the task itself: its job released at ideal_us starts now / is done */
+void jitter_release(int id, int64_t ideal_us);
+void jitter_done(int id);
+
+/* Snapshot of one task's release lateness and response time; 0 if no such id */
+int jitter_get(int id, jitter_stats_t *release, jitter_stats_t *response);
+
+/* Log both for every task */
+void jitter_report(void);
+
+#endif /* LAB2_JITTER_H */
@@ -0,0 +1,15 @@
+/*
+ * Build-time switches of the lab2_q2 app. FreeRTOSConfig.h includes this to
+ * compose its kernel hooks, so the kernel, components/wcet and the app see
+ * the same values.
+ */
+#ifndef LAB2_CONFIG_H
+#define LAB2_CONFIG_H
+
+/* Execution time of each periodic job, blocked and preempted time left out
+   (components/wcet); what taskset.h's wcet column is regenerated from */
+#ifndef WCET_ENABLE
+#define WCET_ENABLE         0
+#endif
+
+#endif /* LAB2_CONFIG_H */
@@ -0,0 +1,57 @@
+/*
+ * lab2_q2 task set: the one place its periods, phases, deadlines, priorities
+ * and execution-time budgets are written down.
+ *
+ * main.c expands LAB2_TASKSET into the periodic task table it starts and into
+ * the rta table rta_admit() checks at boot; rta_check (CMakeLists.txt) runs
+ * the same analysis when the project is configured and stops the build if a
+ * deadline can be missed. Bodies are only named here, so this header also
+ * compiles on the host.
+ *
+ * The priority column names PRIO_* constants that rta_assign generates into
+ * taskset_prio.h (Audsley's optimal priority assignment, also at configure
+ * time): change a period, deadline or budget and the priorities follow.
+ *
+ * The wcet column holds budgets, set by hand from WCET_ENABLE runs of these
+ * jobs on the lab2_q4 host simulator (120 s; maxima 13.5, 13.6 and 100.3 ms
+ * in table order) rounded up to the next ms. All are dominated by ESP_LOGI
+ * lines at console baud, the status job by its every-10 s reports. The LED
+ * mutex is held around nearly the whole LED job, so its hold is the WCET.
+ * To take them from the board instead: set WCET_ENABLE to 1 in
+ * main/lab2_config.h, run for at least 120 s so every job sees its slow
+ * path, then
+ *
+ *   grep -o 'WCETJSON:.*' serial.log | cut -c10- > wcet.jsonl
+ *
+ * and round each task's wcet_us up into its wcet (and LED hold) column.
+ */
+
+#ifndef LAB2_TASKSET_H
+#define LAB2_TASKSET_H
+
+#include "rta.h"
+
+#ifndef RTA_ASSIGN
+#include "taskset_prio.h"
+#endif
+
+#define LOCK_LED            0   /* g_ledMutex: rta_task_t.cs_us index */
+
+/*                name        body             period phase deadline prio                stack  wcet    LED hold
+                              (ms)             (ms)   (ms)  (ms)                               (us)    (us) */
+#define LAB2_TASKSET(X) \
+    X("tLED_ON",  job_led_on,      2000,  0,    1000,    PRIO_TASK1_LED_ON,  1024,  14000,  14000) \
+    X("tLED_OFF", job_led_off,     2000,  1000, 1000,    PRIO_TASK2_LED_OFF, 1024,  14000,  14000) \
+    X("tUART",    job_status_uart, 1000,  0,    0,       PRIO_TASK3_STATUS,  1024,  101000, 0)
+
+#define LAB2_RTA_TASK(name, body, period, phase, deadline, prio, stack, wcet, led_cs) \
+    { name, (period) * 1000u, (deadline) * 1000u, wcet, RTA_PRIO(prio), { [LOCK_LED] = led_cs } },
+#define LAB2_RTA_PRIO_NAME(name, body, period, phase, deadline, prio, stack, wcet, led_cs) \
+    #prio,
+
+/* For rta_check.c and rta_assign.c */
+#define RTA_TASKSET     LAB2_TASKSET(LAB2_RTA_TASK)
+#define RTA_PRIO_NAMES  LAB2_TASKSET(LAB2_RTA_PRIO_NAME)
+#define RTA_PROTOCOL    RTA_PI      /* g_ledMutex is a FreeRTOS mutex */
+
+#endif /* LAB2_TASKSET_H */
@@ -0,0 +1,15 @@
+/* Generated by rta_assign (Audsley's optimal priority assignment) from the
+   task set; do not edit. Worst-case response times at these priorities:
+     tLED_ON    T=2000000 D=1000000 C=14000 B=14000 prio=3 R=28000 us
+     tLED_OFF   T=2000000 D=1000000 C=14000 B=0 prio=2 R=28000 us
+     tUART      T=1000000 D=1000000 C=101000 B=0 prio=1 R=129000 us
+*/
+
+#ifndef LAB2_TASKSET_PRIO_H
+#define LAB2_TASKSET_PRIO_H
+
+#define PRIO_TASK1_LED_ON    3
+#define PRIO_TASK2_LED_OFF   2
+#define PRIO_TASK3_STATUS    1
+
+#endif /* LAB2_TASKSET_PRIO_H */
@@ -4,6 +4,8 @@
 #include "semphr.h"
 #include "driver/gpio.h"
 #include "esp_log.h"
+#include "esp_timer.h"
+#include "precise_delay.h"
 
 #ifndef LED_PIN
 #define LED_PIN 2
@@ -28,24 +30,23 @@ static void led_init(void) {
 static inline void led_on(void)  { gpio_set_level(LED_PIN, 1); }
 static inline void led_off(void) { gpio_set_level(LED_PIN, 0); }
 
-/* T1: LED ON, actively wait 0.5 s, then yield + block 1 tick */
+/* T1: LED ON, wait 0.5 s, then yield + block 1 tick */
 static void task_led_on(void *arg) {
     (void)arg;
-    const TickType_t half_sec = pdMS_TO_TICKS(500);
+    const uint32_t half_sec_us = 500 * 1000;
     for (;;) {
-        TickType_t req = xTaskGetTickCount();
+        int64_t req = esp_timer_get_time();
         xSemaphoreTake(g_ledSem, portMAX_DELAY);
-        TickType_t got = xTaskGetTickCount();
-        ESP_LOGI(TAG, "T1: took LED sem (wait=%lu ms)",
-                 (unsigned long)((got - req) * portTICK_PERIOD_MS));
+        int64_t got = esp_timer_get_time();
+        ESP_LOGI(TAG, "T1: took LED sem (wait=%lu us)",
+                 (unsigned long)(got - req));
 
         led_on();
-        ESP_LOGI(TAG, "T1: LED ON (busy-wait 500 ms)");
+        ESP_LOGI(TAG, "T1: LED ON (wait 500 ms)");
         xSemaphoreGive(g_ledSem);
 
-        /* active wait 500 ms WITHOUT holding the lock */
-        TickType_t start = xTaskGetTickCount();
-        while ((xTaskGetTickCount() - start) < half_sec) { /* spin */ }
+        /* wait 500 ms WITHOUT holding the lock */
+        precise_delay_us(half_sec_us);   /* sleeps all but the last tick, then spins */
 
         taskYIELD();
         vTaskDelay(1); /* ensure lower-priority tasks get CPU */
@@ -57,11 +58,11 @@ static void task_led_off(void *arg) {
     (void)arg;
     const TickType_t one_sec = pdMS_TO_TICKS(1000);
     for (;;) {
-        TickType_t req = xTaskGetTickCount();
+        int64_t req = esp_timer_get_time();
         xSemaphoreTake(g_ledSem, portMAX_DELAY);
-        TickType_t got = xTaskGetTickCount();
-        ESP_LOGI(TAG, "T2: took LED sem (wait=%lu ms)",
-                 (unsigned long)((got - req) * portTICK_PERIOD_MS));
+        int64_t got = esp_timer_get_time();
+        ESP_LOGI(TAG, "T2: took LED sem (wait=%lu us)",
+                 (unsigned long)(got - req));
 
         led_off();
         ESP_LOGI(TAG, "T2: LED OFF (delay 1000 ms)");
@@ -84,6 +85,7 @@ static void task_status(void *arg) {
 void app_main(void) {
     ESP_LOGI(TAG, "app_main: init");
     led_init();
+    precise_delay_init();
 
     /* Binary semaphore == NO priority inheritance */
     g_ledSem = xSemaphoreCreateBinary();
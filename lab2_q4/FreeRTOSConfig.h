@@ -1,95 +1,150 @@
 /*
- * Lab-friendly FreeRTOSConfig.h for ESP8266/ESP-IDF v3.x
- * Enables: preemption, NO timeslicing (so equal priorities are run-to-completion),
- * trace facility with lightweight block tracing hooks.
+ * Lab FreeRTOSConfig.h for ESP8266_RTOS_SDK v3.x, layered on the SDK's own
+ * port config: that one is found next on the include path and still supplies
+ * the port settings (TLS pointers, TASK_SW_ATTR, the idle hook feeding the
+ * watchdog, tick accounting). CMakeLists.txt puts this directory ahead of the
+ * SDK's for every component, so the kernel is compiled with the overrides and
+ * tracing hooks below too. The host simulator's stand-in is host/port.
+ * Overrides: NO timeslicing (so equal priorities are run-to-completion),
+ * trace facility, run-time stats on timebase.c, scheduler tracing hooks
+ * (TRACE_CAT_*, switches in main/lab2_config.h).
  */
 
-#ifndef FREERTOS_CONFIG_H
-#define FREERTOS_CONFIG_H
+#ifndef LAB2_FREERTOS_CONFIG_H
+#define LAB2_FREERTOS_CONFIG_H
 
-#include "sdkconfig.h"
+#include_next "FreeRTOSConfig.h"
+#include "main/lab2_config.h"
 
 #ifndef __ASSEMBLER__
-#include <stdlib.h>
+#include <stdint.h>
 #endif
 
 /* ---- Core scheduling ---- */
-#define portNUM_PROCESSORS                  1
-#define configUSE_PREEMPTION                1
 /* SAME-PRIORITY experiment: run-to-completion (switch only on block/yield) */
+#undef  configUSE_TIME_SLICING
 #define configUSE_TIME_SLICING              0
-
-/* Hooks OFF unless implemented */
-#define configUSE_IDLE_HOOK                 0
-#define configUSE_TICK_HOOK                 0
-
-/* Clock / tick */
-#define configCPU_CLOCK_HZ                  ( 80000000UL )
-#define configTICK_RATE_HZ                  ( (TickType_t) CONFIG_FREERTOS_HZ )
-
-/* Priorities / stacks */
-#define configMAX_PRIORITIES                15
-#define configMINIMAL_STACK_SIZE            ( ( unsigned short ) 768 )
-#define configMAX_TASK_NAME_LEN             16
-#define configUSE_16_BIT_TICKS              0
-#define configIDLE_SHOULD_YIELD             1
-
-/* Safety / debug */
-#define configCHECK_FOR_STACK_OVERFLOW      2
-#define INCLUDE_xTaskGetIdleTaskHandle      1
-#define INCLUDE_uxTaskGetStackHighWaterMark 1
-#define INCLUDE_vTaskPrioritySet            1
-#define INCLUDE_uxTaskPriorityGet           1
-#define INCLUDE_vTaskDelete                 1
-#define INCLUDE_vTaskSuspend                1
-#define INCLUDE_vTaskDelayUntil             1
-#define INCLUDE_vTaskDelay                  1
-#define INCLUDE_xSemaphoreGetMutexHolder    1
-
-/* ----- Sync primitives ----- */
-#define configUSE_MUTEXES                   1
-#define configUSE_RECURSIVE_MUTEXES         1
-#define configUSE_COUNTING_SEMAPHORES       1
 /* Priority Inheritance is enabled by using MUTEXes. */
+#undef  configUSE_PRIORITY_INHERITANCE
 #define configUSE_PRIORITY_INHERITANCE      1
 
-/* Timers (fine to keep) */
-#define configUSE_TIMERS                    1
-#if configUSE_TIMERS
-  #define configTIMER_TASK_PRIORITY         ( tskIDLE_PRIORITY + 2 )
-  #define configTIMER_QUEUE_LENGTH          10
-  #define configTIMER_TASK_STACK_DEPTH      ( ( unsigned short ) CONFIG_FREERTOS_TIMER_STACKSIZE )
-  #define INCLUDE_xTimerPendFunctionCall    1
-#endif
-
-/* Optional / stats */
+/* Optional / stats: on whatever menuconfig says */
+#undef  configUSE_TRACE_FACILITY
 #define configUSE_TRACE_FACILITY            1
+#undef  configUSE_STATS_FORMATTING_FUNCTIONS
 #define configUSE_STATS_FORMATTING_FUNCTIONS 1
-#define configGENERATE_RUN_TIME_STATS       0
-
-/* Interrupt priority placeholders (Cortex-style constants; ESP8266 doesn’t use NVIC) */
-#define configKERNEL_INTERRUPT_PRIORITY         255
-#define configMAX_SYSCALL_INTERRUPT_PRIORITY    191
-#define configLIBRARY_KERNEL_INTERRUPT_PRIORITY 15
-
-#ifndef configIDLE_TASK_STACK_SIZE
-  #define configIDLE_TASK_STACK_SIZE        CONFIG_FREERTOS_IDLE_TASK_STACKSIZE
+#undef  configGENERATE_RUN_TIME_STATS
+#undef  portCONFIGURE_TIMER_FOR_RUN_TIME_STATS
+#undef  portGET_RUN_TIME_COUNTER_VALUE
+#undef  portALT_GET_RUN_TIME_COUNTER_VALUE
+#define configGENERATE_RUN_TIME_STATS       1
+#if configGENERATE_RUN_TIME_STATS
+  /* 64-bit extended CCOUNT >> 4 (timebase.c); the time base needs no setup */
+  #ifndef __ASSEMBLER__
+  uint32_t app_runtime_counter(void);
+  #endif
+  #define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()  ((void)0)
+  #define portGET_RUN_TIME_COUNTER_VALUE()          app_runtime_counter()
 #endif
 
-/* -------- Lightweight block tracing hooks -------- */
+/* -------- Lightweight scheduler tracing hooks -------- */
+#ifndef __ASSEMBLER__
 #ifdef __cplusplus
 extern "C" {
 #endif
-void app_trace_record(const char *reason);   /* Implemented in app_main.c */
+void app_trace_record(uint32_t code, const void *obj, uint32_t arg);   /* Implemented in trace.c */
+void pimon_switched_in(void);                                          /* Implemented in pimon.c */
+void pcprof_sample(void);                                              /* Implemented in pcprof.c */
+void lockio_kernel_call(uint32_t code, const void *obj);               /* Implemented in lockio.c */
+void iterprof_switched_in(void);                                       /* Implemented in iterprof.c */
+void wcet_switched_in(void);                                           /* Implemented in components/wcet */
 #ifdef __cplusplus
 }
 #endif
+#endif
 
+#if LOCKIO_ENABLE
+#define LOCKIO_CALL(code, obj)                   lockio_kernel_call((code), (obj))
+#else
+#define LOCKIO_CALL(code, obj)                   ((void)0)
+#endif
+
+#if TRACE_CAT_BLOCK
+#define TRACE_BLOCK_REC(code, obj)               app_trace_record((code), (obj), 0)
+#else
+#define TRACE_BLOCK_REC(code, obj)               ((void)0)
+#endif
+
+#if TRACE_CAT_BLOCK || LOCKIO_ENABLE
 /* Fires whenever a task blocks due to a delay */
-#define traceTASK_DELAY()                        app_trace_record("DELAY")
-#define traceTASK_DELAY_UNTIL(xTimeToWake)       app_trace_record("DELAY_UNTIL")
+#define traceTASK_DELAY() \
+    do { TRACE_BLOCK_REC(TRACE_EVT_DELAY, NULL); LOCKIO_CALL(TRACE_EVT_DELAY, NULL); } while (0)
+#define traceTASK_DELAY_UNTIL(xTimeToWake) \
+    do { TRACE_BLOCK_REC(TRACE_EVT_DELAY_UNTIL, NULL); LOCKIO_CALL(TRACE_EVT_DELAY_UNTIL, NULL); } while (0)
 /* Fires when a task is about to block waiting on a queue/sem/mutex */
-#define traceBLOCKING_ON_QUEUE_RECEIVE(pxQueue)  app_trace_record("BLOCK_Q_RECV")
-#define traceBLOCKING_ON_QUEUE_PEEK(pxQueue)     app_trace_record("BLOCK_Q_PEEK")
+#define traceBLOCKING_ON_QUEUE_RECEIVE(pxQueue) \
+    do { TRACE_BLOCK_REC(TRACE_EVT_BLOCK_Q_RECV, (pxQueue)); LOCKIO_CALL(TRACE_EVT_BLOCK_Q_RECV, (pxQueue)); } while (0)
+#define traceBLOCKING_ON_QUEUE_PEEK(pxQueue) \
+    do { TRACE_BLOCK_REC(TRACE_EVT_BLOCK_Q_PEEK, (pxQueue)); LOCKIO_CALL(TRACE_EVT_BLOCK_Q_PEEK, (pxQueue)); } while (0)
+#endif
+
+#if TRACE_CAT_SWITCH
+/* Inside vTaskSwitchContext(): current task is the outgoing / incoming one */
+#define traceTASK_SWITCHED_OUT()                 app_trace_record(TRACE_EVT_SWITCH_OUT, NULL, 0)
+#define TRACE_SWITCHED_IN_REC()                  app_trace_record(TRACE_EVT_SWITCH_IN, NULL, 0)
+/* Wake-ups (tick, give, resume): lets the decoder split blocked from ready */
+#define traceMOVED_TASK_TO_READY_STATE(pxTCB)    app_trace_record(TRACE_EVT_READY, (pxTCB), 0)
+#else
+#define TRACE_SWITCHED_IN_REC()                  ((void)0)
+#endif
+
+#if TRACE_CAT_SWITCH || PIMON_ENABLE || ITERPROF_ENABLE || WCET_ENABLE
+#if PIMON_ENABLE
+#define PIMON_SWITCHED_IN()                      pimon_switched_in()
+#else
+#define PIMON_SWITCHED_IN()                      ((void)0)
+#endif
+#if ITERPROF_ENABLE
+#define ITERPROF_SWITCHED_IN()                   iterprof_switched_in()
+#else
+#define ITERPROF_SWITCHED_IN()                   ((void)0)
+#endif
+#if WCET_ENABLE
+#define WCET_SWITCHED_IN()                       wcet_switched_in()
+#else
+#define WCET_SWITCHED_IN()                       ((void)0)
+#endif
+#define traceTASK_SWITCHED_IN() \
+    do { TRACE_SWITCHED_IN_REC(); PIMON_SWITCHED_IN(); ITERPROF_SWITCHED_IN(); WCET_SWITCHED_IN(); } while (0)
+#endif
+
+#if TRACE_CAT_LOCK
+#define TRACE_LOCK_REC(code, obj)                app_trace_record((code), (obj), 0)
+#else
+#define TRACE_LOCK_REC(code, obj)                ((void)0)
+#endif
+
+#if TRACE_CAT_LOCK || LOCKIO_ENABLE
+/* Semaphores and mutexes are queues: a take is a receive, a give is a send */
+#define traceQUEUE_RECEIVE(pxQueue) \
+    do { TRACE_LOCK_REC(TRACE_EVT_TAKE, (pxQueue)); LOCKIO_CALL(TRACE_EVT_TAKE, (pxQueue)); } while (0)
+#define traceQUEUE_SEND(pxQueue) \
+    do { TRACE_LOCK_REC(TRACE_EVT_GIVE, (pxQueue)); LOCKIO_CALL(TRACE_EVT_GIVE, (pxQueue)); } while (0)
+#define traceTAKE_MUTEX_RECURSIVE(pxMutex)       TRACE_LOCK_REC(TRACE_EVT_TAKE_RECURSIVE, (pxMutex))
+#define traceGIVE_MUTEX_RECURSIVE(pxMutex)       TRACE_LOCK_REC(TRACE_EVT_GIVE_RECURSIVE, (pxMutex))
+#endif
+
+#if TRACE_CAT_PI
+#define traceTASK_PRIORITY_INHERIT(pxTCBOfMutexHolder, uxInheritedPriority) \
+    app_trace_record(TRACE_EVT_PI_INHERIT, (pxTCBOfMutexHolder), (uxInheritedPriority))
+#define traceTASK_PRIORITY_DISINHERIT(pxTCBOfMutexHolder, uxOriginalPriority) \
+    app_trace_record(TRACE_EVT_PI_DISINHERIT, (pxTCBOfMutexHolder), (uxOriginalPriority))
+#endif
+
+#if PCPROF_ENABLE && (PCPROF_HZ == 0 || defined(LAB2_HOST))
+/* Tick interrupt, before any context switch: the current task is the one
+   interrupted. The host build has no FRC1 and always samples here. */
+#define traceTASK_INCREMENT_TICK(xTickCount)     pcprof_sample()
+#endif
 
-#endif /* FREERTOS_CONFIG_H */
\ No newline at end of file
+#endif /* LAB2_FREERTOS_CONFIG_H */
@@ -0,0 +1,47 @@
+/*
+ * Host benchmark driver: boots lab2_q4's app_main() on the simulated kernel,
+ * runs it for a fixed stretch of simulated time, then prints the BENCH report
+ * (bench.c) for ledLock. Build one binary per TRACE_MODE with the Makefile.
+ *
+ * Usage: bench_<mode> [-t seconds] [-v] [-s cost_scale] [-p noinit_file]
+ *   -t  simulated run time (default 60)
+ *   -v  print every log line, not just BENCH
+ *   -s  multiply measured hook cost before charging it to simulated time
+ *   -p  warm-reset simulation: boot with the no-init RAM saved in the file
+ *       (if any) and save it there when the run ends, so running twice shows
+ *       the first run's trace as TRR lines (main/trace.h, TRACE_PERSIST)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "lockprof.h"
+#include "bench.h"
+#include "sim.h"
+
+void app_main(void);
+
+int main(int argc, char **argv) {
+    uint32_t seconds = 60;
+    const char *noinit = NULL;
+
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "-t") && i + 1 < argc) {
+            seconds = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (!strcmp(argv[i], "-v")) {
+            sim_set_verbose(1);
+        } else if (!strcmp(argv[i], "-s") && i + 1 < argc) {
+            sim_set_cost_scale(strtod(argv[++i], NULL));
+        } else if (!strcmp(argv[i], "-p") && i + 1 < argc) {
+            noinit = argv[++i];
+        } else {
+            fprintf(stderr, "usage: %s [-t seconds] [-v] [-s cost_scale] [-p noinit_file]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (noinit) sim_noinit_load(noinit);
+    sim_run(app_main, seconds ? seconds : 1);
+    bench_report(lockprof_find("ledLock"));
+    if (noinit) sim_noinit_save(noinit);
+    return 0;
+}
@@ -0,0 +1,19 @@
+#ifndef LAB2_HOST_GPIO_H
+#define LAB2_HOST_GPIO_H
+
+#include <stdint.h>
+
+typedef enum { GPIO_MODE_DISABLE = 0, GPIO_MODE_INPUT, GPIO_MODE_OUTPUT } gpio_mode_t;
+
+typedef struct {
+    uint32_t    pin_bit_mask;
+    gpio_mode_t mode;
+    int         pull_up_en;
+    int         pull_down_en;
+    int         intr_type;
+} gpio_config_t;
+
+int gpio_config(const gpio_config_t *cfg);
+int gpio_set_level(int gpio_num, uint32_t level);
+
+#endif /* LAB2_HOST_GPIO_H */
@@ -0,0 +1,20 @@
+#ifndef LAB2_HOST_ESP_LOG_H
+#define LAB2_HOST_ESP_LOG_H
+
+#include <stdarg.h>
+
+/* Charged as formatting + UART time on the simulated CPU (host/sim.c) */
+void sim_log(char level, const char *tag, const char *fmt, ...)
+    __attribute__((format(printf, 3, 4)));
+
+#define ESP_LOGE(tag, fmt, ...) sim_log('E', tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGW(tag, fmt, ...) sim_log('W', tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGI(tag, fmt, ...) sim_log('I', tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGD(tag, fmt, ...) ((void)0)
+
+/* sim_log() passes each call's format through an installed hook first; the
+   default (returned by the first call) is NULL, as the sim prints itself */
+typedef int (*vprintf_like_t)(const char *, va_list);
+vprintf_like_t esp_log_set_vprintf(vprintf_like_t func);
+
+#endif /* LAB2_HOST_ESP_LOG_H */
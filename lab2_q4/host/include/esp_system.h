@@ -0,0 +1,22 @@
+#ifndef LAB2_HOST_ESP_SYSTEM_H
+#define LAB2_HOST_ESP_SYSTEM_H
+
+/* Same order as ESP8266_RTOS_SDK's esp_system.h */
+typedef enum {
+    ESP_RST_UNKNOWN,
+    ESP_RST_POWERON,
+    ESP_RST_EXT,
+    ESP_RST_SW,
+    ESP_RST_PANIC,
+    ESP_RST_INT_WDT,
+    ESP_RST_TASK_WDT,
+    ESP_RST_WDT,
+    ESP_RST_DEEPSLEEP,
+    ESP_RST_BROWNOUT,
+    ESP_RST_SDIO,
+} esp_reset_reason_t;
+
+/* ESP_RST_TASK_WDT after sim_noinit_load() found a saved region, else POWERON */
+esp_reset_reason_t esp_reset_reason(void);
+
+#endif /* LAB2_HOST_ESP_SYSTEM_H */
@@ -0,0 +1,9 @@
+#ifndef LAB2_HOST_ESP_TIMER_H
+#define LAB2_HOST_ESP_TIMER_H
+
+#include <stdint.h>
+
+/* Microseconds of simulated time since boot */
+int64_t esp_timer_get_time(void);
+
+#endif /* LAB2_HOST_ESP_TIMER_H */
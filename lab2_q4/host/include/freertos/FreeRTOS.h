@@ -0,0 +1,89 @@
+/*
+ * Host build shim: the subset of the FreeRTOS API lab2_q4 uses, backed by
+ * the simulated kernel in host/sim.c. The project's FreeRTOSConfig.h (and so
+ * its trace hooks) is included exactly as on target.
+ */
+
+#ifndef LAB2_HOST_FREERTOS_H
+#define LAB2_HOST_FREERTOS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <assert.h>
+
+typedef uint32_t      TickType_t;
+typedef long          BaseType_t;
+typedef unsigned long UBaseType_t;
+typedef uint32_t      StackType_t;
+typedef void         *TaskHandle_t;
+typedef void         *QueueHandle_t;
+typedef QueueHandle_t SemaphoreHandle_t;
+
+#define pdFALSE         ( ( BaseType_t ) 0 )
+#define pdTRUE          ( ( BaseType_t ) 1 )
+#define pdFAIL          pdFALSE
+#define pdPASS          pdTRUE
+#define portMAX_DELAY   ( TickType_t ) 0xffffffffUL
+#define tskIDLE_PRIORITY ( ( UBaseType_t ) 0U )
+#define IRAM_ATTR
+
+#include "FreeRTOSConfig.h"
+
+#define portTICK_PERIOD_MS  ( ( TickType_t ) 1000 / configTICK_RATE_HZ )
+#define pdMS_TO_TICKS( xTimeInMs ) \
+    ( ( TickType_t ) ( ( ( TickType_t ) ( xTimeInMs ) * ( TickType_t ) configTICK_RATE_HZ ) / ( TickType_t ) 1000 ) )
+
+#ifndef configASSERT
+#define configASSERT( x )   assert( x )
+#endif
+
+/* Critical sections and scheduler suspension both just hold off switching */
+void sim_enter_critical(void);
+void sim_exit_critical(void);
+#define portENTER_CRITICAL()    sim_enter_critical()
+#define portEXIT_CRITICAL()     sim_exit_critical()
+#define taskENTER_CRITICAL()    sim_enter_critical()
+#define taskEXIT_CRITICAL()     sim_exit_critical()
+
+/* Hooks the project leaves undefined are empty, as in the real FreeRTOS.h */
+#ifndef traceTASK_DELAY
+#define traceTASK_DELAY()
+#endif
+#ifndef traceTASK_DELAY_UNTIL
+#define traceTASK_DELAY_UNTIL( x )
+#endif
+#ifndef traceBLOCKING_ON_QUEUE_RECEIVE
+#define traceBLOCKING_ON_QUEUE_RECEIVE( pxQueue )
+#endif
+#ifndef traceBLOCKING_ON_QUEUE_PEEK
+#define traceBLOCKING_ON_QUEUE_PEEK( pxQueue )
+#endif
+#ifndef traceBLOCKING_ON_QUEUE_SEND
+#define traceBLOCKING_ON_QUEUE_SEND( pxQueue )
+#endif
+#ifndef traceTASK_SWITCHED_IN
+#define traceTASK_SWITCHED_IN()
+#endif
+#ifndef traceTASK_SWITCHED_OUT
+#define traceTASK_SWITCHED_OUT()
+#endif
+#ifndef traceMOVED_TASK_TO_READY_STATE
+#define traceMOVED_TASK_TO_READY_STATE( pxTCB )
+#endif
+#ifndef traceQUEUE_RECEIVE
+#define traceQUEUE_RECEIVE( pxQueue )
+#endif
+#ifndef traceQUEUE_SEND
+#define traceQUEUE_SEND( pxQueue )
+#endif
+#ifndef traceTASK_PRIORITY_INHERIT
+#define traceTASK_PRIORITY_INHERIT( pxTCBOfMutexHolder, uxInheritedPriority )
+#endif
+#ifndef traceTASK_PRIORITY_DISINHERIT
+#define traceTASK_PRIORITY_DISINHERIT( pxTCBOfMutexHolder, uxOriginalPriority )
+#endif
+#ifndef traceTASK_INCREMENT_TICK
+#define traceTASK_INCREMENT_TICK( xTickCount )
+#endif
+
+#endif /* LAB2_HOST_FREERTOS_H */
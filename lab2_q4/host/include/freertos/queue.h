@@ -0,0 +1,6 @@
+#ifndef LAB2_HOST_QUEUE_H
+#define LAB2_HOST_QUEUE_H
+
+#include "freertos/FreeRTOS.h"
+
+#endif /* LAB2_HOST_QUEUE_H */
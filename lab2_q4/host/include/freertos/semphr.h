@@ -0,0 +1,12 @@
+#ifndef LAB2_HOST_SEMPHR_H
+#define LAB2_HOST_SEMPHR_H
+
+#include "freertos/queue.h"
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void);
+SemaphoreHandle_t xSemaphoreCreateBinary(void);
+BaseType_t        xSemaphoreTake(SemaphoreHandle_t sem, TickType_t timeout);
+BaseType_t        xSemaphoreGive(SemaphoreHandle_t sem);
+TaskHandle_t      xSemaphoreGetMutexHolder(SemaphoreHandle_t sem);
+
+#endif /* LAB2_HOST_SEMPHR_H */
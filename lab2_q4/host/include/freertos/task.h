@@ -0,0 +1,43 @@
+#ifndef LAB2_HOST_TASK_H
+#define LAB2_HOST_TASK_H
+
+#include "freertos/FreeRTOS.h"
+
+typedef void (*TaskFunction_t)(void *);
+
+typedef enum { eRunning = 0, eReady, eBlocked, eSuspended, eDeleted } eTaskState;
+
+typedef struct {
+    TaskHandle_t xHandle;
+    const char  *pcTaskName;
+    UBaseType_t  xTaskNumber;
+    eTaskState   eCurrentState;
+    UBaseType_t  uxCurrentPriority;
+    UBaseType_t  uxBasePriority;
+    uint32_t     ulRunTimeCounter;
+    StackType_t *pxStackBase;
+    uint16_t     usStackHighWaterMark;
+} TaskStatus_t;
+
+void sim_yield(void);
+#define taskYIELD()     sim_yield()
+
+BaseType_t  xTaskCreate(TaskFunction_t fn, const char *name, uint32_t stack_depth,
+                        void *arg, UBaseType_t prio, TaskHandle_t *out);
+void        vTaskDelete(TaskHandle_t task);
+void        vTaskDelay(TickType_t ticks);
+void        vTaskDelayUntil(TickType_t *prev_wake, TickType_t period);
+TickType_t  xTaskGetTickCount(void);
+char       *pcTaskGetName(TaskHandle_t task);
+TaskHandle_t xTaskGetCurrentTaskHandle(void);
+TaskHandle_t xTaskGetIdleTaskHandle(void);
+UBaseType_t uxTaskGetTaskNumber(TaskHandle_t task);
+void        vTaskSetTaskNumber(TaskHandle_t task, UBaseType_t number);
+UBaseType_t uxTaskPriorityGet(TaskHandle_t task);
+void        vTaskSuspendAll(void);
+BaseType_t  xTaskResumeAll(void);
+UBaseType_t uxTaskGetNumberOfTasks(void);
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task);
+UBaseType_t uxTaskGetSystemState(TaskStatus_t *out, UBaseType_t max, uint32_t *total_run_time);
+
+#endif /* LAB2_HOST_TASK_H */
@@ -0,0 +1,6 @@
+/* Host build: the lab2_q4/sdkconfig values FreeRTOSConfig.h and sim.c use */
+#define CONFIG_FREERTOS_HZ                      100
+#define CONFIG_FREERTOS_IDLE_TASK_STACKSIZE     1024
+#define CONFIG_FREERTOS_TIMER_STACKSIZE         2048
+#define CONFIG_ESP_CONSOLE_UART_BAUDRATE        74880
+#define CONFIG_ESP_MAIN_TASK_STACK_SIZE         3584
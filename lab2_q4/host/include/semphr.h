@@ -0,0 +1 @@
+#include "freertos/semphr.h"
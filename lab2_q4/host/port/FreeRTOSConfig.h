@@ -0,0 +1,46 @@
+/*
+ * Host build: stands in for the SDK's port FreeRTOSConfig.h, which the
+ * project's one extends with #include_next. Only the settings the simulated
+ * kernel reads; the Makefile puts this directory after the project root.
+ */
+
+#ifndef FREERTOS_CONFIG_H
+#define FREERTOS_CONFIG_H
+
+#include "sdkconfig.h"
+
+#ifndef __ASSEMBLER__
+#include <stdlib.h>
+#include <stdint.h>
+#endif
+
+#define portNUM_PROCESSORS                  1
+#define configUSE_PREEMPTION                1
+#define configUSE_IDLE_HOOK                 1
+#define configUSE_TICK_HOOK                 1
+
+#define configCPU_CLOCK_HZ                  ( 80000000UL )
+#define configTICK_RATE_HZ                  ( (TickType_t) CONFIG_FREERTOS_HZ )
+
+#define configMAX_PRIORITIES                15
+#define configMINIMAL_STACK_SIZE            ( ( unsigned short ) 768 )
+#define configMAX_TASK_NAME_LEN             16
+#define configUSE_16_BIT_TICKS              0
+#define configIDLE_SHOULD_YIELD             1
+
+#define configCHECK_FOR_STACK_OVERFLOW      2
+#define INCLUDE_uxTaskGetStackHighWaterMark 1
+#define INCLUDE_vTaskDelayUntil             1
+#define INCLUDE_vTaskDelay                  1
+#define INCLUDE_xSemaphoreGetMutexHolder    1
+#define INCLUDE_xTaskGetCurrentTaskHandle   1
+
+#define configUSE_MUTEXES                   1
+#define configUSE_RECURSIVE_MUTEXES         1
+#define configUSE_COUNTING_SEMAPHORES       1
+
+#ifndef configIDLE_TASK_STACK_SIZE
+#define configIDLE_TASK_STACK_SIZE          CONFIG_FREERTOS_IDLE_TASK_STACKSIZE
+#endif
+
+#endif /* FREERTOS_CONFIG_H */
@@ -0,0 +1,598 @@
+/*
+ * Simulated FreeRTOS kernel (see sim.h).
+ *
+ * Scheduling follows this port's FreeRTOSConfig.h: fixed priorities, highest
+ * ready task runs, equal priorities in ready order, no time slicing,
+ * preemption at tick and kernel-call boundaries, mutex priority inheritance
+ * and hand-off on give. One nesting counter stands for scheduler suspension,
+ * critical sections and the kernel's own internals: while it is non-zero time
+ * still accrues but ticks and switches wait for it to drop to zero.
+ *
+ * The project's trace hooks fire at the points the real kernel fires them,
+ * with the same tasks current, so trace.c / pimon.c run unmodified.
+ *
+ * Costs are rough lx106 figures, not measurements: good enough to put the
+ * workload's own CPU use next to the instrumentation's.
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <time.h>
+#include <ucontext.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "driver/gpio.h"
+#include "esp_log.h"
+#include "esp_system.h"
+#include "timebase.h"
+#include "sim.h"
+
+#define SIM_MAX_TASKS       16
+#define SIM_STACK_BYTES     (256 * 1024)    /* host stack per task */
+#define SIM_CYC_PER_TICK    (configCPU_CLOCK_HZ / configTICK_RATE_HZ)
+
+/* ----- Simulated costs (target cycles) ----- */
+#define SIM_COST_KCALL      300             /* semaphore / delay / create */
+#define SIM_COST_TICK_READ  40              /* xTaskGetTickCount() */
+#define SIM_COST_GPIO       100
+#define SIM_COST_LOG_FMT    4000            /* vprintf before the UART */
+#define SIM_LOG_PREFIX      20              /* "I (12345) lab2: " + CRLF */
+#define SIM_CYC_PER_CHAR    (configCPU_CLOCK_HZ * 10 / CONFIG_ESP_CONSOLE_UART_BAUDRATE)
+
+typedef enum { ST_READY, ST_BLOCKED, ST_DELETED } sim_state_t;
+
+typedef struct sim_sem sim_sem_t;
+
+typedef struct {
+    char        name[configMAX_TASK_NAME_LEN];
+    UBaseType_t prio, base_prio, number;
+    uint32_t    stack_depth;
+    sim_state_t state;
+    uint64_t    ready_seq;          /* ready-list order among equal priorities */
+    int         timed;              /* blocked with a timeout */
+    TickType_t  wake_tick;
+    sim_sem_t  *blocked_on;
+    int         got_it;             /* woken by a give, not by the timeout */
+    uint32_t    rt_counter;
+    TaskFunction_t fn;
+    void       *arg;
+    ucontext_t  ctx;
+    void       *stack;
+} sim_tcb_t;
+
+struct sim_sem {
+    int         mutex;
+    UBaseType_t count, max;
+    sim_tcb_t  *holder;
+};
+
+static sim_tcb_t  g_tasks[SIM_MAX_TASKS];
+static int        g_ntasks;
+static sim_tcb_t *g_cur;
+static sim_tcb_t *g_idle;
+static int        g_started;
+static int        g_stopped;
+static int        g_nest;
+static uint64_t   g_now, g_next_tick, g_end;
+static TickType_t g_ticks;
+static uint64_t   g_seq;
+static uint32_t   g_rt_in;          /* run-time counter at the last switch-in */
+static ucontext_t g_host_ctx;
+static void     (*g_app)(void);
+static int        g_verbose;
+static double     g_cost_scale = 1.0;
+static uint32_t   g_gpio_level;
+
+static void settle(void);
+
+/* ===== Time ===== */
+
+#if PCPROF_ENABLE
+/* Where simulated time is being spent: sim_spend()'s caller and its caller
+   (needs -fno-omit-frame-pointer), as addresses in a non-PIE executable */
+static uintptr_t g_spend_pc, g_spend_caller;
+
+void pcprof_interrupted(uint32_t *pc, uint32_t *caller) {
+    /* Return addresses: step back into the call instruction */
+    *pc = (uint32_t)(g_spend_pc - 1);
+    *caller = (uint32_t)(g_spend_caller - 1);
+}
+#endif
+
+void __attribute__((noinline)) sim_spend(uint64_t cycles) {
+#if PCPROF_ENABLE
+    g_spend_pc = (uintptr_t)__builtin_return_address(0);
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wframe-address"
+    g_spend_caller = (uintptr_t)__builtin_return_address(1);
+#pragma GCC diagnostic pop
+#endif
+    if (g_stopped) {
+        g_now += cycles;
+        return;
+    }
+    do {
+        /* Outside kernel regions stop at each tick so it can preempt */
+        uint64_t step = cycles;
+        if (g_nest == 0 && g_now + step > g_next_tick) step = g_next_tick - g_now;
+        g_now += step;
+        cycles -= step;
+        if (g_nest == 0) settle();
+    } while (cycles);
+}
+
+uint32_t timebase_ccount(void) {
+    return (uint32_t)g_now;
+}
+
+int64_t esp_timer_get_time(void) {
+    return (int64_t)(g_now / (configCPU_CLOCK_HZ / 1000000));
+}
+
+uint32_t timebase_cost_now(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    return (uint32_t)__rdtsc();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)(ts.tv_sec * 1000000000ull + ts.tv_nsec);
+#endif
+}
+
+void timebase_cost_charge(uint32_t cycles) {
+    sim_spend((uint64_t)(cycles * g_cost_scale));
+}
+
+/* ===== Scheduler ===== */
+
+static void make_ready(sim_tcb_t *t) {
+    t->state = ST_READY;
+    t->ready_seq = ++g_seq;
+    traceMOVED_TASK_TO_READY_STATE(t);
+}
+
+static sim_tcb_t *pick(void) {
+    sim_tcb_t *best = NULL;
+    for (int i = 0; i < g_ntasks; ++i) {
+        sim_tcb_t *t = &g_tasks[i];
+        if (t->state != ST_READY) continue;
+        if (best == NULL || t->prio > best->prio ||
+            (t->prio == best->prio && t->ready_seq < best->ready_seq))
+            best = t;
+    }
+    return best;
+}
+
+static void switch_to(sim_tcb_t *next) {
+    sim_tcb_t *prev = g_cur;
+
+    g_nest++;
+    traceTASK_SWITCHED_OUT();
+#if configGENERATE_RUN_TIME_STATS
+    uint32_t rt = portGET_RUN_TIME_COUNTER_VALUE();
+    prev->rt_counter += rt - g_rt_in;
+    g_rt_in = rt;
+#endif
+    g_cur = next;
+    traceTASK_SWITCHED_IN();
+    g_nest--;
+
+    swapcontext(&prev->ctx, &next->ctx);
+}
+
+static void tick(void) {
+    g_ticks++;
+    traceTASK_INCREMENT_TICK(g_ticks);
+    for (int i = 0; i < g_ntasks; ++i) {
+        sim_tcb_t *t = &g_tasks[i];
+        if (t->state != ST_BLOCKED || !t->timed) continue;
+        if ((TickType_t)(g_ticks - t->wake_tick) >= 0x80000000UL) continue;
+        t->blocked_on = NULL;
+        t->got_it = 0;
+        make_ready(t);
+    }
+}
+
+/* Run deferred ticks, stop at the end of the run, switch if needed */
+static void settle(void) {
+    if (g_nest || !g_started || g_stopped) return;
+
+    g_nest++;
+    while (g_now >= g_next_tick) {
+        g_next_tick += SIM_CYC_PER_TICK;
+        tick();
+    }
+    g_nest--;
+
+    if (g_now >= g_end) {
+        g_stopped = 1;
+        swapcontext(&g_cur->ctx, &g_host_ctx);
+    }
+
+    sim_tcb_t *next = pick();
+    if (next != g_cur) switch_to(next);
+}
+
+static void kernel_enter(void) {
+    g_nest++;
+}
+
+static void kernel_exit(void) {
+    if (--g_nest == 0) settle();
+}
+
+void sim_enter_critical(void) { kernel_enter(); }
+void sim_exit_critical(void)  { kernel_exit(); }
+void vTaskSuspendAll(void)    { kernel_enter(); }
+BaseType_t xTaskResumeAll(void) { kernel_exit(); return pdFALSE; }
+
+void sim_yield(void) {
+    /* Back of the ready list for this priority */
+    g_cur->ready_seq = ++g_seq;
+    settle();
+}
+
+/* ===== Tasks ===== */
+
+static void trampoline(void) {
+    g_cur->fn(g_cur->arg);
+    vTaskDelete(NULL);
+}
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char *name, uint32_t stack_depth,
+                       void *arg, UBaseType_t prio, TaskHandle_t *out) {
+    if (g_ntasks == SIM_MAX_TASKS) return pdFAIL;
+    if (g_started) sim_spend(SIM_COST_KCALL);
+
+    sim_tcb_t *t = &g_tasks[g_ntasks];
+    memset(t, 0, sizeof(*t));
+    snprintf(t->name, sizeof(t->name), "%s", name);
+    t->prio = t->base_prio = prio;
+    t->stack_depth = stack_depth;
+    t->fn = fn;
+    t->arg = arg;
+    t->stack = malloc(SIM_STACK_BYTES);
+    if (t->stack == NULL) return pdFAIL;
+    getcontext(&t->ctx);
+    t->ctx.uc_stack.ss_sp = t->stack;
+    t->ctx.uc_stack.ss_size = SIM_STACK_BYTES;
+    t->ctx.uc_link = NULL;
+    makecontext(&t->ctx, trampoline, 0);
+
+    kernel_enter();
+    g_ntasks++;
+    make_ready(t);
+    if (out) *out = t;
+    kernel_exit();
+    return pdPASS;
+}
+
+void vTaskDelete(TaskHandle_t task) {
+    sim_tcb_t *t = task ? (sim_tcb_t *)task : g_cur;
+    kernel_enter();
+    t->state = ST_DELETED;
+    kernel_exit();
+    if (t == g_cur) {
+        fprintf(stderr, "sim: deleted task resumed\n");
+        abort();
+    }
+}
+
+static void block_until(TickType_t wake) {
+    g_cur->state = ST_BLOCKED;
+    g_cur->timed = 1;
+    g_cur->wake_tick = wake;
+}
+
+void vTaskDelay(TickType_t ticks) {
+    sim_spend(SIM_COST_KCALL);
+    if (ticks == 0) {
+        sim_yield();
+        return;
+    }
+    kernel_enter();
+    traceTASK_DELAY();
+    block_until(g_ticks + ticks);
+    kernel_exit();
+}
+
+void vTaskDelayUntil(TickType_t *prev_wake, TickType_t period) {
+    sim_spend(SIM_COST_KCALL);
+    kernel_enter();
+    TickType_t wake = *prev_wake + period;
+    int late = (TickType_t)(wake - g_ticks - 1) >= 0x80000000UL;
+    *prev_wake = wake;
+    if (!late) {
+        traceTASK_DELAY_UNTIL(wake);
+        block_until(wake);
+    }
+    kernel_exit();
+    if (late) sim_yield();
+}
+
+TickType_t xTaskGetTickCount(void) {
+    sim_spend(SIM_COST_TICK_READ);
+    return g_ticks;
+}
+
+char *pcTaskGetName(TaskHandle_t task) {
+    return (task ? (sim_tcb_t *)task : g_cur)->name;
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void) {
+    return g_cur;
+}
+
+TaskHandle_t xTaskGetIdleTaskHandle(void) {
+    return g_idle;
+}
+
+UBaseType_t uxTaskGetTaskNumber(TaskHandle_t task) {
+    return task ? ((sim_tcb_t *)task)->number : 0;
+}
+
+void vTaskSetTaskNumber(TaskHandle_t task, UBaseType_t number) {
+    if (task) ((sim_tcb_t *)task)->number = number;
+}
+
+UBaseType_t uxTaskPriorityGet(TaskHandle_t task) {
+    return (task ? (sim_tcb_t *)task : g_cur)->prio;
+}
+
+UBaseType_t uxTaskGetNumberOfTasks(void) {
+    UBaseType_t n = 0;
+    for (int i = 0; i < g_ntasks; ++i)
+        n += g_tasks[i].state != ST_DELETED;
+    return n;
+}
+
+/* Host stacks say nothing about target stack use: report it all free */
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task) {
+    return (task ? (sim_tcb_t *)task : g_cur)->stack_depth;
+}
+
+UBaseType_t uxTaskGetSystemState(TaskStatus_t *out, UBaseType_t max, uint32_t *total_run_time) {
+    if (uxTaskGetNumberOfTasks() > max) return 0;
+
+    UBaseType_t n = 0;
+    for (int i = 0; i < g_ntasks; ++i) {
+        sim_tcb_t *t = &g_tasks[i];
+        if (t->state == ST_DELETED) continue;
+        TaskStatus_t *s = &out[n++];
+        memset(s, 0, sizeof(*s));
+        s->xHandle = t;
+        s->pcTaskName = t->name;
+        s->xTaskNumber = t->number;
+        s->eCurrentState = (t == g_cur) ? eRunning : (t->state == ST_READY) ? eReady : eBlocked;
+        s->uxCurrentPriority = t->prio;
+        s->uxBasePriority = t->base_prio;
+        s->ulRunTimeCounter = t->rt_counter;
+        s->usStackHighWaterMark = (uint16_t)t->stack_depth;
+    }
+#if configGENERATE_RUN_TIME_STATS
+    if (total_run_time) *total_run_time = portGET_RUN_TIME_COUNTER_VALUE();
+#else
+    if (total_run_time) *total_run_time = 0;
+#endif
+    return n;
+}
+
+/* ===== Semaphores ===== */
+
+static SemaphoreHandle_t sem_create(int mutex, UBaseType_t count) {
+    sim_sem_t *s = calloc(1, sizeof(*s));
+    if (s == NULL) return NULL;
+    sim_spend(SIM_COST_KCALL);
+    s->mutex = mutex;
+    s->count = count;
+    s->max = 1;
+    return s;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void)  { return sem_create(1, 1); }
+SemaphoreHandle_t xSemaphoreCreateBinary(void) { return sem_create(0, 0); }
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t timeout) {
+    sim_sem_t *s = sem;
+
+    sim_spend(SIM_COST_KCALL);
+    kernel_enter();
+    if (s->count) {
+        s->count--;
+        if (s->mutex) s->holder = g_cur;
+        traceQUEUE_RECEIVE(s);
+        kernel_exit();
+        return pdTRUE;
+    }
+    if (timeout == 0) {
+        kernel_exit();
+        return pdFALSE;
+    }
+
+    traceBLOCKING_ON_QUEUE_RECEIVE(s);
+    if (s->mutex && s->holder && s->holder->prio < g_cur->prio) {
+        traceTASK_PRIORITY_INHERIT(s->holder, g_cur->prio);
+        s->holder->prio = g_cur->prio;
+    }
+    g_cur->state = ST_BLOCKED;
+    g_cur->blocked_on = s;
+    g_cur->got_it = 0;
+    g_cur->timed = (timeout != portMAX_DELAY);
+    g_cur->wake_tick = g_ticks + timeout;
+    kernel_exit();
+
+    /* Resumed by a give (the lock was handed over) or by the timeout */
+    if (!g_cur->got_it) return pdFALSE;
+    kernel_enter();
+    traceQUEUE_RECEIVE(s);
+    kernel_exit();
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem) {
+    sim_sem_t *s = sem;
+
+    sim_spend(SIM_COST_KCALL);
+    kernel_enter();
+    if ((s->mutex && s->holder != g_cur) || (!s->mutex && s->count >= s->max)) {
+        kernel_exit();
+        return pdFAIL;
+    }
+    traceQUEUE_SEND(s);
+    if (s->mutex) {
+        if (g_cur->prio != g_cur->base_prio) {
+            traceTASK_PRIORITY_DISINHERIT(g_cur, g_cur->base_prio);
+            g_cur->prio = g_cur->base_prio;
+        }
+        s->holder = NULL;
+    }
+
+    sim_tcb_t *w = NULL;
+    for (int i = 0; i < g_ntasks; ++i) {
+        sim_tcb_t *t = &g_tasks[i];
+        if (t->state == ST_BLOCKED && t->blocked_on == s && (w == NULL || t->prio > w->prio))
+            w = t;
+    }
+    if (w) {
+        w->blocked_on = NULL;
+        w->got_it = 1;
+        if (s->mutex) s->holder = w;
+        make_ready(w);
+    } else {
+        s->count++;
+    }
+    kernel_exit();
+    return pdTRUE;
+}
+
+TaskHandle_t xSemaphoreGetMutexHolder(SemaphoreHandle_t sem) {
+    return ((sim_sem_t *)sem)->holder;
+}
+
+/* ===== Devices ===== */
+
+int gpio_config(const gpio_config_t *cfg) {
+    (void)cfg;
+    sim_spend(SIM_COST_GPIO);
+    return 0;
+}
+
+int gpio_set_level(int gpio_num, uint32_t level) {
+    sim_spend(SIM_COST_GPIO);
+    if (level) g_gpio_level |= 1u << gpio_num;
+    else       g_gpio_level &= ~(1u << gpio_num);
+    return 0;
+}
+
+static vprintf_like_t g_log_vprintf = NULL;
+
+vprintf_like_t esp_log_set_vprintf(vprintf_like_t func) {
+    vprintf_like_t prev = g_log_vprintf;
+    g_log_vprintf = func;
+    return prev;
+}
+
+void sim_log(char level, const char *tag, const char *fmt, ...) {
+    char line[256];
+    va_list ap;
+    if (g_log_vprintf) {
+        va_start(ap, fmt);
+        g_log_vprintf(fmt, ap);
+        va_end(ap);
+    }
+    va_start(ap, fmt);
+    int n = vsnprintf(line, sizeof(line), fmt, ap);
+    va_end(ap);
+    if (n < 0) n = 0;
+
+    if (g_verbose || !strcmp(tag, "BENCH"))
+        printf("%c (%lu) %s: %s\n", level, (unsigned long)(g_now / (configCPU_CLOCK_HZ / 1000)),
+               tag, line);
+    /* The UART drains at console baud while the caller spins on the FIFO */
+    sim_spend(SIM_COST_LOG_FMT + (uint64_t)(n + (int)strlen(tag) + SIM_LOG_PREFIX) * SIM_CYC_PER_CHAR);
+}
+
+/* ===== Boot ===== */
+
+static void idle_task(void *arg) {
+    (void)arg;
+    for (;;) sim_spend(g_next_tick - g_now);   /* nothing happens before the next tick */
+}
+
+static void main_task(void *arg) {
+    (void)arg;
+    g_app();
+}
+
+/* ===== No-init RAM ===== */
+
+/* Bounds of the section, from the linker; NULL if nothing was put there */
+extern uint8_t __start_lab2_noinit[] __attribute__((weak));
+extern uint8_t __stop_lab2_noinit[] __attribute__((weak));
+
+static esp_reset_reason_t g_reset_reason = ESP_RST_POWERON;
+
+esp_reset_reason_t esp_reset_reason(void) {
+    return g_reset_reason;
+}
+
+int sim_noinit_load(const char *path) {
+    size_t n = (size_t)(__stop_lab2_noinit - __start_lab2_noinit);
+    FILE *f = fopen(path, "rb");
+
+    if (f == NULL || fread(__start_lab2_noinit, 1, n, f) != n) {
+        /* Power-on: RAM holds whatever it powers up with */
+        for (size_t i = 0; i < n; ++i) __start_lab2_noinit[i] = (uint8_t)rand();
+        if (f) fclose(f);
+        return 0;
+    }
+    fclose(f);
+    g_reset_reason = ESP_RST_TASK_WDT;
+    return 1;
+}
+
+void sim_noinit_save(const char *path) {
+    size_t n = (size_t)(__stop_lab2_noinit - __start_lab2_noinit);
+    FILE *f = fopen(path, "wb");
+
+    if (f == NULL) {
+        perror(path);
+        return;
+    }
+    fwrite(__start_lab2_noinit, 1, n, f);
+    fclose(f);
+}
+
+void sim_set_verbose(int on) {
+    g_verbose = on;
+}
+
+void sim_set_cost_scale(double scale) {
+    g_cost_scale = scale;
+}
+
+void sim_run(void (*app)(void), uint32_t seconds) {
+    g_app = app;
+    g_end = (uint64_t)seconds * configCPU_CLOCK_HZ;
+    g_next_tick = SIM_CYC_PER_TICK;
+
+    TaskHandle_t idle;
+    xTaskCreate(idle_task, "IDLE", configMINIMAL_STACK_SIZE, NULL, tskIDLE_PRIORITY, &idle);
+    g_idle = idle;
+    xTaskCreate(main_task, "uiT", CONFIG_ESP_MAIN_TASK_STACK_SIZE, NULL, 1, NULL);
+
+    g_started = 1;
+    g_cur = pick();
+    g_nest++;
+    traceTASK_SWITCHED_IN();
+    g_nest--;
+    swapcontext(&g_host_ctx, &g_cur->ctx);
+    fflush(stdout);
+}
@@ -0,0 +1,37 @@
+/*
+ * Simulated single-core FreeRTOS kernel for host builds of lab2_q4.
+ *
+ * Tasks are ucontext coroutines on one simulated CPU at configCPU_CLOCK_HZ.
+ * Simulated time only moves when code spends it: kernel calls, tick reads,
+ * GPIO writes and log lines charge fixed cycle costs (log lines also their
+ * UART time), and instrumentation charges its measured host cost through
+ * timebase_cost_charge(). See sim.c for the scheduling rules.
+ */
+
+#ifndef LAB2_HOST_SIM_H
+#define LAB2_HOST_SIM_H
+
+#include <stdint.h>
+
+/* Print every log line (default: only BENCH lines) */
+void sim_set_verbose(int on);
+
+/* Multiply measured instrumentation cost (host cycles) before charging it */
+void sim_set_cost_scale(double scale);
+
+/* Boot: create IDLE and main (runs app), schedule until seconds of simulated
+   time have passed, then return to the caller. Afterwards the caller may
+   read the app's state; nothing is scheduled any more */
+void sim_run(void (*app)(void), uint32_t seconds);
+
+/* The app's no-init RAM (the lab2_noinit section, see TRACE_PERSIST in
+   main/trace.h) across a simulated warm reset: save it when a run ends as if
+   the watchdog fired there, load it before the next run boots. Load returns
+   0 (and leaves the region as a power-on would) if path does not exist. */
+int  sim_noinit_load(const char *path);
+void sim_noinit_save(const char *path);
+
+/* Advance simulated time by cycles as the running task */
+void sim_spend(uint64_t cycles);
+
+#endif /* LAB2_HOST_SIM_H */
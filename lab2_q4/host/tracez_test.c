@@ -0,0 +1,490 @@
+/*
+ * Host test of the compact trace stream (main/tracez.c) and its decoder in
+ * tools/trace2json. Plain C, no simulated kernel; build and run with
+ * `make test`.
+ *
+ * Usage: tracez_test [trace2json]
+ *
+ * Every stream is encoded, decoded back and compared event by event, with
+ * no slack: cycles down to the 2^TRACEZ_SHIFT unit, an elided SWITCH_OUT
+ * back at the following SWITCH_IN's time, and exactly one event fewer only
+ * when the stream ends on an elided SWITCH_OUT. Every strict prefix of a
+ * record must decode to nothing and leave the decoder state alone. With a
+ * trace2json path, crafted serial logs (truncated banks, corrupt varints,
+ * garbled TRZ lines) go through it too. Exits 1 on any failure.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "tracez.h"
+
+#define T_MASK      (0xffffffffu >> TRACEZ_SHIFT)
+#define CYC_MASK    (~((1u << TRACEZ_SHIFT) - 1))
+#define MAX_EVTS    4096
+#define OBJ(k)      (0x3fff0000u + (uint32_t)(k) * 0x40)
+
+static int fails = 0;
+static const char *what = "";
+
+#define CHECK(c) do {                                                           \
+        if (!(c)) {                                                             \
+            fprintf(stderr, "%s:%d: %s: CHECK(%s) failed\n", __FILE__, __LINE__, \
+                    what, #c);                                                  \
+            fails++;                                                            \
+        }                                                                       \
+    } while (0)
+
+static tracez_evt_t evt(uint32_t cycles, uint8_t task, uint8_t code, uint32_t obj, uint8_t arg) {
+    tracez_evt_t e = { cycles, obj, task, code, arg };
+    return e;
+}
+
+static int evt_eq(const tracez_evt_t *a, const tracez_evt_t *b) {
+    return a->cycles == b->cycles && a->obj == b->obj && a->task == b->task &&
+           a->code == b->code && a->arg == b->arg;
+}
+
+static uint8_t stream[MAX_EVTS * TRACEZ_MAX_REC];
+
+/* Hand-written sequences: seq[0..nseq), each event step cycles after the last */
+static tracez_evt_t seq[64];
+static uint32_t seq_len[64];
+static unsigned nseq;
+static uint32_t cseq;
+
+static void seq_start(void) {
+    nseq = 0;
+    cseq = 0;
+}
+
+static void add(uint32_t step, uint8_t task, uint8_t code, uint32_t obj, uint8_t arg) {
+    cseq += step;
+    seq[nseq++] = evt(cseq, task, code, obj, arg);
+}
+
+/* Encode in[0..n) into stream[]; lens[i] gets each record's length */
+static uint32_t encode(const tracez_evt_t *in, unsigned n, const uint32_t *seeds,
+                       uint8_t nseeds, uint32_t *lens) {
+    tracez_state_t st;
+    uint32_t len = 0;
+
+    tracez_reset(&st, seeds, nseeds);
+    for (unsigned i = 0; i < n; ++i) {
+        uint32_t l = tracez_encode(&st, &in[i], stream + len);
+        CHECK(l <= TRACEZ_MAX_REC);
+        if (lens) lens[i] = l;
+        len += l;
+    }
+    return len;
+}
+
+/* Events in p[0..len) up to the first record that does not decode */
+static unsigned decodable(const uint8_t *p, uint32_t len, const uint32_t *seeds, uint8_t nseeds) {
+    tracez_state_t st;
+    tracez_evt_t d[2];
+    unsigned got = 0;
+
+    tracez_reset(&st, seeds, nseeds);
+    for (uint32_t off = 0, nd, l; off < len; off += l, got += nd)
+        if ((l = tracez_decode(&st, p + off, len - off, d, &nd)) == 0) break;
+    return got;
+}
+
+/* Round-trip in[0..n) exactly; returns the stream length */
+static uint32_t round_trip(const tracez_evt_t *in, unsigned n, const uint32_t *seeds,
+                           uint8_t nseeds, uint32_t *lens) {
+    static tracez_evt_t want[MAX_EVTS];
+    static uint32_t l_in[MAX_EVTS];
+    unsigned nwant = 0, got = 0;
+    int held = -1;      /* elided SWITCH_OUT waiting for its SWITCH_IN */
+
+    if (!lens) lens = l_in;
+    uint32_t len = encode(in, n, seeds, nseeds, lens);
+
+    for (unsigned i = 0; i < n; ++i) {
+        if (lens[i] == 0) {
+            CHECK(in[i].code == TRACE_EVT_SWITCH_OUT && held < 0);
+            held = (int)i;
+            continue;
+        }
+        if (held >= 0) {
+            CHECK(in[i].code == TRACE_EVT_SWITCH_IN);
+            want[nwant] = in[held];
+            want[nwant++].cycles = in[i].cycles & CYC_MASK;
+            held = -1;
+        }
+        want[nwant] = in[i];
+        want[nwant++].cycles &= CYC_MASK;
+    }
+    CHECK(nwant == n - (held >= 0));
+
+    tracez_state_t st, before;
+    tracez_evt_t d[2];
+    uint32_t off = 0, nd;
+
+    tracez_reset(&st, seeds, nseeds);
+    for (unsigned i = 0; i < n; ++i) {
+        if (lens[i] == 0) continue;
+        for (uint32_t k = 0; k < lens[i]; ++k) {
+            before = st;
+            CHECK(tracez_decode(&st, stream + off, k, d, &nd) == 0);
+            CHECK(memcmp(&st, &before, sizeof(st)) == 0);
+        }
+        uint32_t l = tracez_decode(&st, stream + off, len - off, d, &nd);
+        CHECK(l == lens[i]);
+        if (l != lens[i]) break;
+        off += l;
+        for (uint32_t k = 0; k < nd; ++k, ++got)
+            CHECK(got < nwant && evt_eq(&d[k], &want[got]));
+    }
+    CHECK(off == len);
+    CHECK(got == nwant);
+    return len;
+}
+
+/* ===== Object dictionary ===== */
+
+static void test_dict(void) {
+    static const uint32_t seeds[3] = { 0x3ffe1000, 0x3ffe2000, 0x3ffe3000 };
+    static uint32_t many[TRACEZ_DICT + 2];
+
+    /* 3 seeds, then 11 slots round-robin: 30 new objects wrap them twice */
+    what = "dictionary, 3 seeds";
+    seq_start();
+    for (unsigned k = 0; k < 3; ++k) add(64, 1, TRACE_EVT_TAKE, seeds[k], 0);
+    for (unsigned k = 0; k < 30; ++k) add(64, 1, TRACE_EVT_TAKE, OBJ(k), 0);
+    add(64, 1, TRACE_EVT_TAKE, OBJ(29), 0);         /* newest */
+    add(64, 1, TRACE_EVT_TAKE, OBJ(19), 0);         /* oldest kept */
+    add(64, 1, TRACE_EVT_TAKE, OBJ(18), 0);         /* evicted: takes 19's slot */
+    add(64, 1, TRACE_EVT_TAKE, OBJ(19), 0);
+    add(64, 1, TRACE_EVT_TAKE, seeds[0], 0);        /* seeds never move */
+    add(64, 1, TRACE_EVT_TAKE, seeds[2], 0);
+    round_trip(seq, nseq, seeds, 3, seq_len);
+    for (unsigned i = 0; i < 3; ++i) CHECK(seq_len[i] == 3);
+    for (unsigned i = 3; i < 33; ++i) CHECK(seq_len[i] == 7);
+    CHECK(seq_len[33] == 3 && seq_len[34] == 3 && seq_len[35] == 7 && seq_len[36] == 7);
+    CHECK(seq_len[37] == 3 && seq_len[38] == 3);
+
+    /* No seeds: all 14 slots rotate */
+    what = "dictionary, no seeds";
+    seq_start();
+    for (unsigned k = 0; k < 20; ++k) add(64, 2, TRACE_EVT_GIVE, OBJ(k), 0);
+    for (unsigned k = 6; k < 20; ++k) add(64, 2, TRACE_EVT_GIVE, OBJ(k), 0);
+    add(64, 2, TRACE_EVT_GIVE, OBJ(5), 0);
+    round_trip(seq, nseq, NULL, 0, seq_len);
+    for (unsigned i = 0; i < 20; ++i) CHECK(seq_len[i] == 7);
+    for (unsigned i = 20; i < 34; ++i) CHECK(seq_len[i] == 3);
+    CHECK(seq_len[34] == 7);
+
+    /* More seeds than slots: capped, one slot left to rotate */
+    what = "dictionary, seeds capped";
+    for (unsigned k = 0; k < TRACEZ_DICT + 2; ++k) many[k] = 0x3ffe0000u + k * 0x100;
+    seq_start();
+    add(64, 3, TRACE_EVT_READY, many[TRACEZ_DICT - 2], 0);
+    add(64, 3, TRACE_EVT_READY, many[TRACEZ_DICT - 1], 0);     /* not a seed */
+    add(64, 3, TRACE_EVT_READY, OBJ(1), 0);
+    add(64, 3, TRACE_EVT_READY, many[TRACEZ_DICT - 1], 0);
+    round_trip(seq, nseq, many, TRACEZ_DICT + 2, seq_len);
+    CHECK(seq_len[0] == 3 && seq_len[1] == 7 && seq_len[2] == 7 && seq_len[3] == 7);
+}
+
+/* ===== Args ===== */
+
+static void test_args(void) {
+    what = "args";
+    seq_start();
+    add(0, 2, TRACE_EVT_DELAY, 0, 0);               /* no ext byte */
+    add(64, 2, TRACE_EVT_LOCK_WAIT, 0, 1);          /* inline args */
+    add(64, 2, TRACE_EVT_LOCK_WAIT, 0, 14);
+    add(64, 2, TRACE_EVT_LOCK_WAIT, 0, 15);         /* literal args */
+    add(64, 2, TRACE_EVT_LOCK_WAIT, 0, 255);
+    add(64, 2, TRACE_EVT_PI_INHERIT, OBJ(1), 200);  /* literal obj and arg */
+    add(64, 2, TRACE_EVT_PI_INHERIT, OBJ(1), 9);
+    add(64, 2, TRACE_EVT_PI_DISINHERIT, OBJ(1), 15);
+    add(64, 2, TRACE_EVT_READY, OBJ(2), 0);         /* literal obj only */
+    round_trip(seq, nseq, NULL, 0, seq_len);
+    CHECK(seq_len[0] == 2);
+    CHECK(seq_len[1] == 3 && seq_len[2] == 3);
+    CHECK(seq_len[3] == 4 && seq_len[4] == 4);
+    CHECK(seq_len[5] == 8 && seq_len[6] == 3 && seq_len[7] == 4);
+    CHECK(seq_len[8] == 7);
+}
+
+/* ===== Context switches ===== */
+
+static void test_switch(void) {
+    const uint8_t IN = TRACE_EVT_SWITCH_IN, OUT = TRACE_EVT_SWITCH_OUT;
+
+    what = "switches";
+    seq_start();
+    add(1000, 0, OUT, 0, 0);            /* running task unknown yet */
+    add(1000, 1, IN, 0, 0);
+    add(1000, 1, TRACE_EVT_DELAY, 0, 0);
+    add(1000, 1, OUT, 0, 0);            /* elided */
+    add(1000, 7, IN, 0, 0);             /* brings it back */
+    add(1000, 7, TRACE_EVT_TAKE, OBJ(3), 0);
+    add(1000, 7, OUT, 0, 3);            /* arg: explicit */
+    add(1000, 3, IN, 0, 0);             /* stands alone */
+    add(1000, 5, OUT, 0, 0);            /* not the running task: explicit */
+    add(1000, 7, IN, 0, 0);
+    add(1000, 7, TRACE_EVT_READY, OBJ(3), 0);
+    add(1000, 7, OUT, OBJ(3), 0);       /* obj: explicit */
+    add(1000, 4, IN, 0, 0);
+    add(1000, 4, OUT, 0, 0);            /* elided */
+    add(1000, 0, IN, 0, 0);
+    add(1000, 0, OUT, 0, 0);            /* elided, ends the stream */
+    round_trip(seq, nseq, NULL, 0, seq_len);
+    CHECK(seq_len[0] == 2 && seq_len[1] == 2);
+    CHECK(seq_len[3] == 0 && seq_len[13] == 0 && seq_len[15] == 0);
+    CHECK(seq_len[6] == 3 && seq_len[8] == 2 && seq_len[11] == 3);
+    CHECK(decodable(stream, encode(seq, nseq, NULL, 0, NULL), NULL, 0) == nseq - 1);
+}
+
+/* ===== Timestamps ===== */
+
+static void test_dt(void) {
+    static const uint32_t dts[]  = { 0, 127, 128, 16383, 16384, (1u << 21) - 1, 1u << 21, T_MASK };
+    static const uint32_t want[] = { 2, 2,   3,   3,     4,     4,               5,       5 };
+    const unsigned ndt = sizeof(dts) / sizeof(dts[0]);
+
+    what = "dt varint";
+    seq_start();
+    add(0x1234567fu, 1, TRACE_EVT_DELAY, 0, 0);     /* low bits are dropped */
+    for (unsigned k = 0; k < ndt; ++k) add(dts[k] << TRACEZ_SHIFT, 1, TRACE_EVT_DELAY, 0, 0);
+    add(0xffffffc0u - cseq, 1, TRACE_EVT_DELAY, 0, 0);
+    add(0x80, 1, TRACE_EVT_DELAY, 0, 0);            /* CCOUNT wraps to 0x40: dt 2 */
+    round_trip(seq, nseq, NULL, 0, seq_len);
+    for (unsigned k = 0; k < ndt; ++k) CHECK(seq_len[k + 1] == want[k]);
+    CHECK(seq[nseq - 1].cycles == 0x40 && seq_len[nseq - 1] == 2);
+
+    /* Decoder only: the longest varint it takes, one too long, too short */
+    what = "dt varint, decoder";
+    static const uint8_t five[] = { 0x11, 0x81, 0x80, 0x80, 0x80, 0x01 };
+    static const uint8_t six[]  = { 0x11, 0x80, 0x80, 0x80, 0x80, 0x80, 0x00, 0, 0, 0, 0, 0 };
+    tracez_state_t st;
+    tracez_evt_t d[2];
+    uint32_t nd;
+
+    tracez_reset(&st, NULL, 0);
+    CHECK(tracez_decode(&st, five, sizeof(five), d, &nd) == sizeof(five));
+    CHECK(nd == 1 && d[0].cycles == 1u << TRACEZ_SHIFT);   /* bit 28 is above T_MASK */
+    tracez_reset(&st, NULL, 0);
+    CHECK(tracez_decode(&st, six, sizeof(six), d, &nd) == 0);
+    CHECK(tracez_decode(&st, six, 1, d, &nd) == 0);
+}
+
+/* ===== Random banks ===== */
+
+#define NTASKS  4       /* 0 = idle, 1..3 registered */
+#define HANDLE(t)   (0x3ffe1000u + (uint32_t)(t) * 0x100)
+
+/* A bank's worth of plausible events, ending on an elided SWITCH_OUT */
+static unsigned gen_bank(tracez_evt_t *out, unsigned n, uint32_t seed) {
+    uint32_t r = seed, c = seed * 64;
+    uint8_t run = 1;
+    unsigned i = 0;
+
+    out[i++] = evt(c, run, TRACE_EVT_SWITCH_IN, 0, 0);
+    while (i + 5 <= n) {
+        r = r * 1103515245u + 12345u;
+        c += ((r >> 8) % 20000) * ((r & 1) ? 1 : 97);
+        switch ((r >> 24) & 7) {
+        case 0:
+        case 1:
+            out[i++] = evt(c, run, TRACE_EVT_SWITCH_OUT, 0, 0);
+            run = (uint8_t)((r >> 16) % NTASKS);
+            c += 64;
+            out[i++] = evt(c, run, TRACE_EVT_SWITCH_IN, 0, 0);
+            break;
+        case 2:  out[i++] = evt(c, run, TRACE_EVT_TAKE, OBJ((r >> 12) % 20), 0); break;
+        case 3:  out[i++] = evt(c, run, TRACE_EVT_GIVE, OBJ((r >> 12) % 20), 0); break;
+        case 4:  out[i++] = evt(c, run, TRACE_EVT_PI_INHERIT, HANDLE(1 + (r >> 12) % 3), (uint8_t)(r >> 16)); break;
+        case 5:  out[i++] = evt(c, run, TRACE_EVT_READY, HANDLE(1 + (r >> 12) % 3), 0); break;
+        case 6:  out[i++] = evt(c, run, TRACE_EVT_DELAY_UNTIL, 0, 0); break;
+        default: out[i++] = evt(c, run, TRACE_EVT_LOCK_WAIT, OBJ((r >> 12) % 20), (uint8_t)((r >> 4) % 20)); break;
+        }
+    }
+    out[i++] = evt(c + 128, run, TRACE_EVT_SWITCH_OUT, 0, 0);
+    out[i++] = evt(c + 192, 7, TRACE_EVT_SWITCH_IN, 0, 0);
+    out[i++] = evt(c + 256, 7, TRACE_EVT_SWITCH_OUT, 0, 0);
+    return i;
+}
+
+static const uint32_t task_seeds[NTASKS - 1] = { HANDLE(1), HANDLE(2), HANDLE(3) };
+
+static void test_random(void) {
+    static tracez_evt_t in[MAX_EVTS];
+
+    what = "random banks";
+    for (uint32_t s = 1; s <= 20; ++s) {
+        unsigned n = gen_bank(in, 200 * s, s);
+        round_trip(in, n, task_seeds, NTASKS - 1, NULL);
+        round_trip(in, n, NULL, 0, NULL);
+    }
+}
+
+/* ===== trace2json ===== */
+
+static char log_buf[1 << 20];
+static size_t log_len;
+
+static void log_put(const char *s) {
+    size_t l = strlen(s);
+    if (log_len + l < sizeof(log_buf)) {
+        memcpy(log_buf + log_len, s, l + 1);
+        log_len += l;
+    }
+}
+
+/* TRB line, then the bytes as TRZ lines of 48 (the target's width), so
+   records straddle lines; garble != 0 puts "zz" before byte garble_at */
+static void log_bank(unsigned n, const uint8_t *p, uint32_t len, int garble, uint32_t garble_at) {
+    char line[16 + 2 * 48 + 4];
+
+    snprintf(line, sizeof(line), "I (123) TRACE: TRB:%u,%u\n", n, NTASKS - 1);
+    log_put(line);
+    for (uint32_t i = 0; i < len; i += 48) {
+        char *o = line + sprintf(line, "TRZ:");
+        for (uint32_t k = i; k < len && k < i + 48; ++k) {
+            if (garble && k == garble_at) o += sprintf(o, "zz");
+            o += sprintf(o, "%02x", p[k]);
+        }
+        strcpy(o, "\r\n");
+        log_put(line);
+    }
+}
+
+static void log_start(void) {
+    char line[64];
+
+    log_len = 0;
+    log_put("ets Jan  8 2013,rst cause:2, boot mode:(3,6)\n");
+    for (unsigned t = 1; t < NTASKS; ++t) {
+        snprintf(line, sizeof(line), "TRT:%u,%08x,task%u\n", t, (unsigned)HANDLE(t), t);
+        log_put(line);
+    }
+}
+
+/* Run trace2json on log_buf; returns its record count, err gets stderr */
+static long run_t2j(const char *tool, char *err, size_t errsz) {
+    char cmd[512], tail[8] = "";
+    FILE *f;
+    long recs = -1;
+
+    if (!(f = fopen("tracez_test.log", "w"))) return -1;
+    fwrite(log_buf, 1, log_len, f);
+    fclose(f);
+    snprintf(cmd, sizeof(cmd), "%s < tracez_test.log > tracez_test.json 2> tracez_test.err", tool);
+    CHECK(system(cmd) == 0);
+
+    err[0] = '\0';
+    if ((f = fopen("tracez_test.err", "r"))) {
+        err[fread(err, 1, errsz - 1, f)] = '\0';
+        fclose(f);
+    }
+    const char *s = strstr(err, "trace2json: ");
+    while (s && sscanf(s, "trace2json: %ld records", &recs) != 1) s = strstr(s + 1, "trace2json: ");
+
+    /* The JSON must be closed off whatever the input was */
+    if ((f = fopen("tracez_test.json", "r"))) {
+        if (fseek(f, -4, SEEK_END) == 0) tail[fread(tail, 1, 4, f)] = '\0';
+        fclose(f);
+    }
+    CHECK(strcmp(tail, "\n]}\n") == 0);
+    return recs;
+}
+
+static void test_trace2json(const char *tool) {
+    static tracez_evt_t a[MAX_EVTS], b[MAX_EVTS];
+    static uint8_t za[MAX_EVTS * TRACEZ_MAX_REC], zb[MAX_EVTS * TRACEZ_MAX_REC];
+    static char err[4096];
+    unsigned na = gen_bank(a, 500, 7), nb = gen_bank(b, 300, 8);
+    uint32_t la = encode(a, na, task_seeds, NTASKS - 1, NULL);
+    memcpy(za, stream, la);
+    uint32_t lb = encode(b, nb, task_seeds, NTASKS - 1, NULL);
+    memcpy(zb, stream, lb);
+    const long good_b = nb - 1;     /* each bank ends on an elided SWITCH_OUT */
+
+    what = "trace2json, good banks";
+    log_start();
+    log_bank(na, za, la, 0, 0);
+    log_put("TRL:3\n");
+    log_bank(nb, zb, lb, 0, 0);
+    CHECK(run_t2j(tool, err, sizeof(err)) == (long)(na - 1) + good_b);
+    CHECK(!strstr(err, "truncated") && !strstr(err, "undecodable"));
+
+    what = "trace2json, truncated bank";
+    log_start();
+    log_bank(na, za, la - 5, 0, 0);
+    log_bank(nb, zb, lb, 0, 0);
+    CHECK(run_t2j(tool, err, sizeof(err)) == (long)decodable(za, la - 5, task_seeds, NTASKS - 1) + good_b);
+    CHECK(strstr(err, "TRZ bank truncated") && !strstr(err, "undecodable"));
+
+    what = "trace2json, short count";
+    log_start();
+    log_bank(na + 5, za, la, 0, 0);
+    CHECK(run_t2j(tool, err, sizeof(err)) == (long)(na - 1));
+    CHECK(strstr(err, "TRZ bank truncated"));
+
+    /* A varint longer than any record spliced in after the first 100 bytes' records */
+    what = "trace2json, corrupt varint";
+    static uint8_t zc[MAX_EVTS * TRACEZ_MAX_REC + 16];
+    static const uint8_t bad[TRACEZ_MAX_REC] = { 0x12, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x7f };
+    tracez_state_t st;
+    tracez_evt_t d[2];
+    uint32_t cut = 0, nd, l;
+    tracez_reset(&st, task_seeds, NTASKS - 1);
+    while (cut < 100 && (l = tracez_decode(&st, za + cut, la - cut, d, &nd)) != 0) cut += l;
+    memcpy(zc, za, cut);
+    memcpy(zc + cut, bad, sizeof(bad));
+    memcpy(zc + cut + sizeof(bad), za + cut, la - cut);
+    log_start();
+    log_bank(na, zc, la + sizeof(bad), 0, 0);
+    log_bank(nb, zb, lb, 0, 0);
+    CHECK(run_t2j(tool, err, sizeof(err)) == (long)decodable(za, cut, task_seeds, NTASKS - 1) + good_b);
+    CHECK(strstr(err, "undecodable") && !strstr(err, "truncated"));
+
+    what = "trace2json, corrupt first record";
+    log_start();
+    log_bank(na, bad, sizeof(bad), 0, 0);
+    log_bank(nb, zb, lb, 0, 0);
+    CHECK(run_t2j(tool, err, sizeof(err)) == good_b);
+    CHECK(strstr(err, "undecodable"));
+
+    /* Garbage inside a TRZ line: the bytes after it are out of step */
+    what = "trace2json, garbled line";
+    log_start();
+    log_bank(na, za, la, 1, 130);
+    log_bank(nb, zb, lb, 0, 0);
+    CHECK(run_t2j(tool, err, sizeof(err)) == (long)decodable(za, 96, task_seeds, NTASKS - 1) + good_b);
+    CHECK(strstr(err, "undecodable"));
+
+    what = "trace2json, TRZ without TRB";
+    log_start();
+    log_bank(nb, zb, lb, 0, 0);
+    memmove(log_buf, strstr(log_buf, "TRZ:"), strlen(strstr(log_buf, "TRZ:")) + 1);
+    log_len = strlen(log_buf);
+    CHECK(run_t2j(tool, err, sizeof(err)) >= 0);
+
+    remove("tracez_test.log");
+    remove("tracez_test.json");
+    remove("tracez_test.err");
+}
+
+int main(int argc, char **argv) {
+    if (argc > 2) {
+        fprintf(stderr, "usage: %s [trace2json]\n", argv[0]);
+        return 2;
+    }
+    test_dict();
+    test_args();
+    test_switch();
+    test_dt();
+    test_random();
+    if (argc == 2) test_trace2json(argv[1]);
+
+    printf("tracez_test: %s (%d failed)\n", fails ? "FAILED" : "ok", fails);
+    return fails ? 1 : 0;
+}
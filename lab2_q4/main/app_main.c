@@ -1,14 +1,36 @@
 #include <stdio.h>
-#include <string.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "semphr.h"
 #include "driver/gpio.h"
 #include "esp_log.h"
+#include "esp_system.h"
+#include "esp_timer.h"
+#include "trace.h"
+#include "lockprof.h"
+#include "pimon.h"
+#include "cpustat.h"
+#include "timebase.h"
+#include "bench.h"
+#include "pcprof.h"
+#include "critprof.h"
+#include "lockio.h"
+#include "iterprof.h"
+#include "precise_delay.h"
+#include "wcet.h"
 
 /* ====== Switches for Q3 experiments ====== */
 #define USE_MUTEX       1   /* 1 = case (c) PI enabled; 0 = case (b) no PI (binary semaphore) */
 #define SAME_PRIORITY   0   /* 1 = all tasks same prio (run-to-completion), 0 = case (a) T1>T2>T3 */
+/* 1 = add tMED, a CPU-bound task between T1 and T2 that T2 wakes while it
+   holds the LED lock: without PI it runs while T1 waits on T2 (the inversion
+   pimon reports), with PI T2 inherits T1's priority and tMED waits instead */
+#ifndef MED_INTERFERER
+#define MED_INTERFERER  (!USE_MUTEX && !SAME_PRIORITY)
+#endif
+#if MED_INTERFERER && SAME_PRIORITY
+#error "MED_INTERFERER needs distinct priorities (SAME_PRIORITY 0)"
+#endif
 
 /* ----- Hardware ----- */
 #ifndef LED_PIN
@@ -23,7 +45,10 @@ static const char *TAG = "lab2";
   static const int PRIO_TASK2_LED_OFF  = 2;
   static const int PRIO_TASK3_STATUS   = 2;
 #else
-  static const int PRIO_TASK1_LED_ON   = 3;  /* highest */
+  static const int PRIO_TASK1_LED_ON   = 3 + MED_INTERFERER;  /* highest */
+#if MED_INTERFERER
+  static const int PRIO_TASK_MED       = 3;  /* between T1 and T2 */
+#endif
   static const int PRIO_TASK2_LED_OFF  = 2;
   static const int PRIO_TASK3_STATUS   = 1;
 #endif
@@ -37,42 +62,57 @@ static const char *g_lockKind =
   "binsem(noPI)";
 #endif
 
-/* ===== Tiny block-trace buffer (pairs with FreeRTOSConfig.h hooks) ===== */
-typedef struct {
-    uint32_t tick_ms;
-    char     task[8];
-    char     reason[16];
-} BlockEvt;
-
-#define TRACE_BUF_SZ 64
-static volatile uint32_t trace_idx = 0;
-static BlockEvt trace_buf[TRACE_BUF_SZ];
-
-void app_trace_record(const char *reason) {
-    /* Keep it tiny to minimize perturbation */
-    uint32_t i = __atomic_fetch_add(&trace_idx, 1, __ATOMIC_RELAXED);
-    BlockEvt *e = &trace_buf[i % TRACE_BUF_SZ];
-    e->tick_ms = xTaskGetTickCount() * portTICK_PERIOD_MS;
-    snprintf(e->task,   sizeof(e->task),   "%s", pcTaskGetName(NULL));
-    snprintf(e->reason, sizeof(e->reason), "%s", reason);
-}
+#if MED_INTERFERER
+static SemaphoreHandle_t g_medGo;   /* T2 -> tMED release */
+#endif
 
+/* ===== Block-trace summary (binary ring lives in trace.c) ===== */
 static void dump_trace_summary(void) {
-    static uint32_t last_idx = 0;
-    uint32_t now_idx = trace_idx;
-    uint32_t dly=0, dlyu=0, blk=0;
-
-    for (uint32_t i = last_idx; i < now_idx; ++i) {
-        BlockEvt *e = &trace_buf[i % TRACE_BUF_SZ];
-        if      (!strcmp(e->reason, "DELAY"))        dly++;
-        else if (!strcmp(e->reason, "DELAY_UNTIL"))  dlyu++;
-        else if (!strcmp(e->reason, "BLOCK_Q_RECV") ||
-                 !strcmp(e->reason, "BLOCK_Q_PEEK")) blk++;
-    }
-    ESP_LOGI("TRACE", "last 1s: DELAY=%u DELAY_UNTIL=%u BLOCK_ON_LOCK=%u", dly, dlyu, blk);
-    last_idx = now_idx;
+    uint32_t n[TRACE_EVT_COUNT];
+    trace_batch_t batch;
+
+    trace_counts_take(n);   /* counts since the previous call, exact at any event rate */
+    trace_swap(&batch);     /* records since the previous call + how many were dropped */
+    ESP_LOGI("TRACE", "last 1s: DELAY=%u DELAY_UNTIL=%u BLOCK_ON_LOCK=%u",
+             (unsigned)n[TRACE_EVT_DELAY], (unsigned)n[TRACE_EVT_DELAY_UNTIL],
+             (unsigned)(n[TRACE_EVT_BLOCK_Q_RECV] + n[TRACE_EVT_BLOCK_Q_PEEK]));
+    ESP_LOGI("TRACE", "last 1s: SWITCH=%u TAKE=%u GIVE=%u PI_INHERIT=%u PI_DISINHERIT=%u",
+             (unsigned)n[TRACE_EVT_SWITCH_IN], (unsigned)n[TRACE_EVT_TAKE],
+             (unsigned)n[TRACE_EVT_GIVE], (unsigned)n[TRACE_EVT_PI_INHERIT],
+             (unsigned)n[TRACE_EVT_PI_DISINHERIT]);
+#if TRACE_DUMP_RAW
+    trace_dump_raw(&batch);   /* decode on the host: tools/trace2json */
+#endif
+    if (batch.lost)
+        ESP_LOGW("TRACE", "kept %u records, lost %u (total lost %u), raise TRACE_BANK_SZ",
+                 (unsigned)batch.n, (unsigned)batch.lost, (unsigned)batch.lost_total);
 }
 
+/* ===== Triggered capture: trace around a T1 lock wait over 20 ms ===== */
+#ifndef CAPTURE_WAIT_US
+#define CAPTURE_WAIT_US 20000
+#endif
+#define CAPTURE_POST    16      /* records kept after the trigger */
+
+#if TRACE_TRIGGER
+static uint8_t g_t1_index;      /* T1's trace index, set once it registers */
+
+static void arm_capture(void) {
+    trace_trigger_t t = { .code = TRACE_EVT_LOCK_WAIT, .task = g_t1_index,
+                          .post = CAPTURE_POST, .min_value = CAPTURE_WAIT_US };
+    trace_trigger_arm(&t);
+}
+
+static void check_capture(void) {
+    trace_capture_t c;
+    if (!trace_capture_take(&c)) return;
+    ESP_LOGW("TRACE", "trigger: T1 waited >= %u us, %u records (trigger at #%u)",
+             (unsigned)CAPTURE_WAIT_US, (unsigned)c.n, (unsigned)c.trig);
+    trace_capture_dump(&c);     /* decode on the host: tools/trace2json */
+    arm_capture();
+}
+#endif
+
 /* ----- GPIO helpers ----- */
 static void led_init(void) {
     gpio_config_t io = (gpio_config_t){0};
@@ -85,35 +125,63 @@ static inline void led_on(void)  { gpio_set_level(LED_PIN, 1); }
 static inline void led_off(void) { gpio_set_level(LED_PIN, 0); }
 
 /* ===== Tasks per assignment =====
-   T1: LED ON, actively wait 0.5 s, then yield; also block 1 tick to ensure progress.
+   T1: LED ON, wait 0.5 s, then yield; also block 1 tick to ensure progress.
    T2: LED OFF, delay 1 s.
    T3: status every 1 s + trace summary print.
+   tMED (MED_INTERFERER): spins 300 ms each time T2 releases it.
 */
 
 /* T1 */
 static void task_led_on(void *arg) {
     (void)arg;
-    const TickType_t half_sec = pdMS_TO_TICKS(500);
+    const uint32_t half_sec_us = 500 * 1000;
 
+    trace_register_task(NULL);
+#if TRACE_TRIGGER
+    g_t1_index = trace_self_index();
+    arm_capture();
+#endif
+    int it = iterprof_register("T1");
+    int wc = wcet_register("task_led_on");
     for (;;) {
-        TickType_t t0 = xTaskGetTickCount();
-        xSemaphoreTake(g_ledLock, portMAX_DELAY);
-        TickType_t t1 = xTaskGetTickCount();
+        iterprof_begin(it);
+        wcet_begin(wc);
+        uint64_t t0 = timebase_us();
+        lockprof_take(g_ledLock, portMAX_DELAY);
+        uint64_t t1 = timebase_us();
+        iterprof_mark(it, ITERPROF_LOCK_WAIT);
 
-        ESP_LOGI(TAG, "T1: took LED %s (wait=%lu ms)", g_lockKind,
-                 (unsigned long)((t1 - t0) * portTICK_PERIOD_MS));
+        ESP_LOGI(TAG, "T1: took LED %s (wait=%lu us)", g_lockKind,
+                 (unsigned long)(t1 - t0));
+        iterprof_mark(it, ITERPROF_LOG);
 
         led_on();
-        ESP_LOGI(TAG, "T1: LED ON (busy-wait 500 ms)");
-        xSemaphoreGive(g_ledLock);
+        iterprof_mark(it, ITERPROF_LOCK_HELD);
+        ESP_LOGI(TAG, "T1: LED ON (wait 500 ms)");
+        iterprof_mark(it, ITERPROF_LOG);
+        lockprof_give(g_ledLock);
+        iterprof_mark(it, ITERPROF_LOCK_HELD);
 
-        /* active wait (do NOT hold the lock) */
+        /* wait (do NOT hold the lock) */
+        int64_t deadline = esp_timer_get_time() + half_sec_us;
+#if TICK_SPIN_WAIT
         TickType_t start = xTaskGetTickCount();
-        while ((xTaskGetTickCount() - start) < half_sec) { /* spin */ }
+        while ((xTaskGetTickCount() - start) < pdMS_TO_TICKS(half_sec_us / 1000)) { /* spin */ }
+        iterprof_mark(it, ITERPROF_BUSY);
+#else
+        precise_delay_sleep_until(deadline);
+        iterprof_mark(it, ITERPROF_DELAY);
+        precise_delay_spin_until(deadline);
+        iterprof_mark(it, ITERPROF_BUSY);
+#endif
+        bench_wait_done(deadline);
 
         /* match spec + guarantee progress for lower priorities */
         taskYIELD();
         vTaskDelay(1);
+        iterprof_mark(it, ITERPROF_DELAY);
+        iterprof_end(it);
+        wcet_end(wc);
     }
 }
 
@@ -122,32 +190,105 @@ static void task_led_off(void *arg) {
     (void)arg;
     const TickType_t one_sec = pdMS_TO_TICKS(1000);
 
+    trace_register_task(NULL);
+    int it = iterprof_register("T2");
+    int wc = wcet_register("task_led_off");
     for (;;) {
-        TickType_t t0 = xTaskGetTickCount();
-        xSemaphoreTake(g_ledLock, portMAX_DELAY);
-        TickType_t t1 = xTaskGetTickCount();
+        iterprof_begin(it);
+        wcet_begin(wc);
+        uint64_t t0 = timebase_us();
+        lockprof_take(g_ledLock, portMAX_DELAY);
+        uint64_t t1 = timebase_us();
+        iterprof_mark(it, ITERPROF_LOCK_WAIT);
 
-        ESP_LOGI(TAG, "T2: took LED %s (wait=%lu ms)", g_lockKind,
-                 (unsigned long)((t1 - t0) * portTICK_PERIOD_MS));
+        ESP_LOGI(TAG, "T2: took LED %s (wait=%lu us)", g_lockKind,
+                 (unsigned long)(t1 - t0));
+        iterprof_mark(it, ITERPROF_LOG);
 
         led_off();
+#if MED_INTERFERER
+        xSemaphoreGive(g_medGo);        /* tMED preempts us, lock held */
+#endif
+        iterprof_mark(it, ITERPROF_LOCK_HELD);
         ESP_LOGI(TAG, "T2: LED OFF (delay 1000 ms)");
-        xSemaphoreGive(g_ledLock);
+        iterprof_mark(it, ITERPROF_LOG);
+        lockprof_give(g_ledLock);
+        iterprof_mark(it, ITERPROF_LOCK_HELD);
 
         vTaskDelay(one_sec);
+        iterprof_mark(it, ITERPROF_DELAY);
+        iterprof_end(it);
+        wcet_end(wc);
     }
 }
 
-/* T3 */
+#if MED_INTERFERER
+/* tMED: released by T2 with the LED lock held, then spins MED_BUSY_MS */
+#ifndef MED_BUSY_MS
+#define MED_BUSY_MS     300
+#endif
+
+static void task_med(void *arg) {
+    (void)arg;
+    const TickType_t busy = pdMS_TO_TICKS(MED_BUSY_MS);
+
+    trace_register_task(NULL);
+    for (;;) {
+        xSemaphoreTake(g_medGo, portMAX_DELAY);
+        TickType_t start = xTaskGetTickCount();
+        while ((xTaskGetTickCount() - start) < busy) { /* spin: never blocks */ }
+    }
+}
+#endif
+
+/* T3: every report runs in turn on this task's 1024 stack, so a report
+   keeps its line buffers and snapshots static, not as stack locals */
 static void task_status(void *arg) {
     (void)arg;
     const TickType_t one_sec = pdMS_TO_TICKS(1000);
     static int first = 1;
+    uint32_t n = 0;
+#if BENCH_SECONDS
+    int bench_done = 0;
+#endif
 
+    trace_register_task(NULL);
+    int wc = wcet_register("task_status");
     for (;;) {
-        if (first) { ESP_LOGI(TAG, "Status: lock=%s, SAME_PRIORITY=%d", g_lockKind, SAME_PRIORITY); first = 0; }
+        wcet_begin(wc);
+        if (first) { ESP_LOGI(TAG, "Status: lock=%s, SAME_PRIORITY=%d, MED_INTERFERER=%d", g_lockKind, SAME_PRIORITY, MED_INTERFERER); first = 0; }
         dump_trace_summary();
+#if TRACE_TRIGGER
+        check_capture();
+#endif
+#if PCPROF_ENABLE
+        pcprof_dump();      /* symbolise on the host: tools/pcprof */
+#endif
+        cpustat_report();
         ESP_LOGI(TAG, "T3: tick=%lu", (unsigned long)xTaskGetTickCount());
+        if (++n % 10 == 0) {                  /* every 10 s */
+            lockprof_dump();
+            pimon_dump();
+#if CRITPROF_ENABLE
+            critprof_report();
+#endif
+#if LOCKIO_ENABLE
+            lockio_report();
+#endif
+#if ITERPROF_ENABLE
+            iterprof_report();
+#endif
+#if WCET_ENABLE
+            wcet_report();
+#endif
+        }
+#if BENCH_SECONDS
+        if (!bench_done && timebase_us() >= BENCH_SECONDS * 1000000ULL) {
+            bench_report(g_ledLock);        /* T1 starves T3: go by time, not by n */
+            bench_done = 1;
+        }
+#endif
+        wcet_end(wc);
         vTaskDelay(one_sec);
     }
 }
@@ -156,6 +297,23 @@ static void task_status(void *arg) {
 void app_main(void) {
     ESP_LOGI(TAG, "app_main: init");
     led_init();
+    precise_delay_init();
+
+#if TRACE_PERSIST
+    /* A task WDT / panic / stack overflow reset keeps the trace banks */
+    esp_reset_reason_t why = esp_reset_reason();
+    uint32_t prev = trace_prev_dump((int)why);
+    if (prev)
+        ESP_LOGW(TAG, "reset reason %d: previous run's last %u trace records above (TRR)",
+                 (int)why, (unsigned)prev);
+#endif
+#if TRACE_BENCH
+    trace_bench();
+#endif
+    trace_register_task(xTaskGetIdleTaskHandle());
+#if PCPROF_ENABLE
+    pcprof_start();
+#endif
 
 #if USE_MUTEX
     g_ledLock = xSemaphoreCreateMutex();              /* (c) PI enabled */
@@ -164,8 +322,19 @@ void app_main(void) {
     xSemaphoreGive(g_ledLock);                        /* start unlocked */
 #endif
     configASSERT(g_ledLock != NULL);
+    lockprof_register(g_ledLock, "ledLock");
+#if MED_INTERFERER
+    g_medGo = xSemaphoreCreateBinary();               /* T2 gives it: create first */
+    configASSERT(g_medGo != NULL);
+#endif
+#if LOCKIO_ENABLE
+    lockio_start();
+#endif
 
     xTaskCreate(task_led_on,  "tLED_ON",  1024, NULL, PRIO_TASK1_LED_ON,  NULL);
     xTaskCreate(task_led_off, "tLED_OFF", 1024, NULL, PRIO_TASK2_LED_OFF, NULL);
     xTaskCreate(task_status,  "tSTATUS",  1024, NULL, PRIO_TASK3_STATUS,  NULL);
+#if MED_INTERFERER
+    xTaskCreate(task_med,     "tMED",     1024, NULL, PRIO_TASK_MED,      NULL);
+#endif
 }
\ No newline at end of file
@@ -0,0 +1,68 @@
+#include <stdio.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "trace.h"
+#include "lockprof.h"
+#include "cpustat.h"
+#include "timebase.h"
+#include "bench.h"
+
+static const char *TAG = "BENCH";
+
+/* Deadline error of T1's waits: end minus deadline, us */
+static uint32_t g_wait_n = 0;
+static int32_t  g_wait_min = INT32_MAX, g_wait_max = INT32_MIN;
+static uint64_t g_wait_abs = 0;
+
+void bench_wait_done(int64_t deadline_us) {
+    int32_t err = (int32_t)(esp_timer_get_time() - deadline_us);
+    g_wait_n++;
+    if (err < g_wait_min) g_wait_min = err;
+    if (err > g_wait_max) g_wait_max = err;
+    g_wait_abs += (uint64_t)(err < 0 ? -err : err);
+}
+
+static const char *mode_name(void) {
+    switch (TRACE_MODE) {
+    case TRACE_MODE_OFF:    return "off";
+    case TRACE_MODE_STRING: return "string";
+    default:                return "binary";
+    }
+}
+
+/* "<=N" bound of a lockprof percentile, ">=N" for the open last bucket */
+static const char *pct_bound(char *buf, size_t len, uint32_t us) {
+    if (us == UINT32_MAX) snprintf(buf, len, ">=%u", (unsigned)LOCKPROF_OPEN_US);
+    else                  snprintf(buf, len, "<=%u", (unsigned)us);
+    return buf;
+}
+
+void bench_report(SemaphoreHandle_t lock) {
+    uint32_t busy = cpustat_busy_permille();
+    uint32_t cyc = 0, evts = 0;
+#if TRACE_SELF_TIME
+    trace_cost(&cyc, &evts);
+#endif
+
+    ESP_LOGI(TAG, "mode=%s run=%lu ms hooks=%u cost=%u cyc/hook cpu_busy=%u.%u%%",
+             mode_name(), (unsigned long)(timebase_us() / 1000), (unsigned)evts,
+             (unsigned)(evts ? cyc / evts : 0), (unsigned)(busy / 10), (unsigned)(busy % 10));
+
+    if (g_wait_n)
+        ESP_LOGI(TAG, "mode=%s wait=%s n=%u err min=%d mean|err|=%u max=%d us",
+                 mode_name(), TICK_SPIN_WAIT ? "tick_spin" : "precise", (unsigned)g_wait_n,
+                 (int)g_wait_min, (unsigned)(g_wait_abs / g_wait_n), (int)g_wait_max);
+
+    for (uint8_t t = 1; t < TRACE_MAX_TASKS; ++t) {
+        static lockprof_stat_t s;
+        if (!lockprof_get(lock, t, &s) || s.acq == 0) continue;
+        static char p50[16], p99[16];
+        ESP_LOGI(TAG, "mode=%s wait %s: n=%u contended=%u p50%s p99%s max=%u us",
+                 mode_name(), trace_task_name(t), (unsigned)s.acq, (unsigned)s.contended,
+                 pct_bound(p50, sizeof(p50), lockprof_hist_pct(s.wait_hist, 50)),
+                 pct_bound(p99, sizeof(p99), lockprof_hist_pct(s.wait_hist, 99)),
+                 (unsigned)s.wait_max_us);
+    }
+}
@@ -0,0 +1,41 @@
+/*
+ * Instrumentation-overhead benchmark for lab2_q4.
+ *
+ * Build the same workload with TRACE_MODE = OFF / STRING / BINARY and
+ * TRACE_SELF_TIME = 1, let it run BENCH_SECONDS, and compare the BENCH lines:
+ * per-hook cost, CPU busy share, and the T1/T2 lock wait distributions.
+ * host/ runs all three modes on simulated time without a board.
+ *
+ * The same report compares T1's 500 ms wait implementations (TICK_SPIN_WAIT
+ * below): CPU busy share plus how far each wait ended from its
+ * deadline. `make waitbench` in host/ runs both.
+ */
+
+#ifndef LAB2_BENCH_H
+#define LAB2_BENCH_H
+
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "lab2_config.h"
+
+/* task_status prints the report at its first pass after this many seconds
+   from boot (0 = never) */
+#ifndef BENCH_SECONDS
+#define BENCH_SECONDS   0
+#endif
+
+/* T1's 500 ms wait: 1 = poll the tick count (the original busy-wait),
+   0 = precise_delay_until(), sleep then spin */
+#ifndef TICK_SPIN_WAIT
+#define TICK_SPIN_WAIT  0
+#endif
+
+/* T1's wait that should have ended at deadline_us (esp_timer_get_time())
+   returned just now */
+void bench_wait_done(int64_t deadline_us);
+
+/* Log the BENCH summary for the lock the workload contends on */
+void bench_report(SemaphoreHandle_t lock);
+
+#endif /* LAB2_BENCH_H */
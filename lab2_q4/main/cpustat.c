@@ -0,0 +1,70 @@
+#include <stdio.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "cpustat.h"
+
+static const char *TAG = "CPU";
+
+/* Static: TaskStatus_t arrays are too big for the status task's stack */
+static TaskStatus_t g_status[CPUSTAT_MAX_TASKS];
+static struct {
+    TaskHandle_t h;
+    uint32_t     last;      /* ulRunTimeCounter at the previous report */
+} g_prev[CPUSTAT_MAX_TASKS];
+static UBaseType_t g_nprev = 0;
+static uint32_t g_prev_total = 0;
+
+static uint32_t prev_counter(TaskHandle_t h) {
+    for (UBaseType_t i = 0; i < g_nprev; ++i)
+        if (g_prev[i].h == h) return g_prev[i].last;
+    return 0;   /* new task: its whole run time falls in this window */
+}
+
+void cpustat_report(void) {
+    uint32_t total;
+    UBaseType_t n = uxTaskGetSystemState(g_status, CPUSTAT_MAX_TASKS, &total);
+    if (n == 0) {
+        ESP_LOGW(TAG, "more than %d tasks, raise CPUSTAT_MAX_TASKS", CPUSTAT_MAX_TASKS);
+        return;
+    }
+
+    /* Unsigned deltas stay correct across the 32-bit counter wrap */
+    uint32_t window = total - g_prev_total;
+    TaskHandle_t idle = xTaskGetIdleTaskHandle();
+    uint32_t idle_pm = 0;
+    static char line[CPUSTAT_MAX_TASKS * 24];
+    int len = 0;
+
+    for (UBaseType_t i = 0; i < n; ++i) {
+        const TaskStatus_t *t = &g_status[i];
+        uint32_t delta = t->ulRunTimeCounter - prev_counter(t->xHandle);
+        uint32_t pm = window ? (uint32_t)((uint64_t)delta * 1000 / window) : 0;
+
+        if (t->xHandle == idle) idle_pm = pm;
+        else if (pm && len < (int)sizeof(line))
+            len += snprintf(line + len, sizeof(line) - len, " %s=%u.%u%%",
+                            t->pcTaskName, (unsigned)(pm / 10), (unsigned)(pm % 10));
+    }
+    line[len < (int)sizeof(line) ? len : (int)sizeof(line) - 1] = '\0';
+
+    for (UBaseType_t i = 0; i < n; ++i) {
+        g_prev[i].h = g_status[i].xHandle;
+        g_prev[i].last = g_status[i].ulRunTimeCounter;
+    }
+    g_nprev = n;
+    g_prev_total = total;
+
+    ESP_LOGI(TAG, "last window:%s IDLE=%u.%u%%", line, (unsigned)(idle_pm / 10), (unsigned)(idle_pm % 10));
+}
+
+uint32_t cpustat_busy_permille(void) {
+    uint32_t total;
+    UBaseType_t n = uxTaskGetSystemState(g_status, CPUSTAT_MAX_TASKS, &total);
+    TaskHandle_t idle = xTaskGetIdleTaskHandle();
+
+    for (UBaseType_t i = 0; i < n; ++i)
+        if (g_status[i].xHandle == idle && total)
+            return 1000 - (uint32_t)((uint64_t)g_status[i].ulRunTimeCounter * 1000 / total);
+    return 0;
+}
@@ -0,0 +1,23 @@
+/*
+ * Per-task CPU utilisation for lab2_q4 from FreeRTOS run-time stats.
+ *
+ * The run-time counter is the 64-bit CCOUNT time base (timebase.c) scaled to
+ * 5 MHz; cpustat_report() turns counter deltas since its previous call into
+ * per-task and idle percentages without vTaskGetRunTimeStats().
+ */
+
+#ifndef LAB2_CPUSTAT_H
+#define LAB2_CPUSTAT_H
+
+#include <stdint.h>
+
+#define CPUSTAT_MAX_TASKS   12      /* user + idle + timer + system tasks */
+
+/* Log CPU % per task and idle % over the window since the previous call */
+void cpustat_report(void);
+
+/* Non-idle share of the CPU since boot, in permille (run-time counter wraps
+   after ~14 min, so only meaningful for shorter runs) */
+uint32_t cpustat_busy_permille(void);
+
+#endif /* LAB2_CPUSTAT_H */
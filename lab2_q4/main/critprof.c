@@ -0,0 +1,103 @@
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "critprof.h"
+
+#if CRITPROF_ENABLE
+
+static const char *TAG = "CRITPROF";
+static const char *const kind_names[CRITPROF_KINDS] = { "crit", "suspend", "atomic" };
+
+static critprof_site_t *g_sites = NULL;
+
+/* Outermost open window per kind. Only one task can be inside either at a
+   time (interrupts off / no switches), and ISRs never open them. */
+static critprof_site_t *g_open[2];
+static uint32_t g_t0[2];
+static uint32_t g_depth[2];
+
+/* Raw PS save/restore as in timebase.c: atomics are also timed in the trace
+   hooks and ISRs, where the critical nesting count must not be touched */
+static inline uint32_t cp_lock(void) {
+#ifdef LAB2_HOST
+    return 0;
+#else
+    uint32_t ps;
+    __asm__ __volatile__("rsil %0, 15" : "=a"(ps) :: "memory");
+    return ps;
+#endif
+}
+
+static inline void cp_unlock(uint32_t ps) {
+#ifdef LAB2_HOST
+    (void)ps;
+#else
+    __asm__ __volatile__("wsr %0, ps; rsync" :: "a"(ps) : "memory");
+#endif
+}
+
+static void record(critprof_site_t *s, uint32_t cyc) {
+    uint32_t ps = cp_lock();
+    if (!s->linked) {
+        s->linked = 1;
+        s->next = g_sites;
+        g_sites = s;
+    }
+    s->n++;
+    s->total_cyc += cyc;
+    if (cyc > s->max_cyc) s->max_cyc = cyc;
+    cp_unlock(ps);
+}
+
+void critprof_enter(critprof_site_t *site) {
+    uint8_t k = site->kind;
+    if (g_depth[k]++ == 0) {
+        g_open[k] = site;
+        g_t0[k] = timebase_cost_now();
+    }
+}
+
+void critprof_exit(uint8_t kind) {
+    uint32_t t1 = timebase_cost_now();
+    if (g_depth[kind] == 0 || --g_depth[kind] != 0) return;
+    record(g_open[kind], t1 - g_t0[kind]);
+}
+
+void critprof_atomic(critprof_site_t *site, uint32_t cycles) {
+    record(site, cycles);
+}
+
+void critprof_report(void) {
+    for (uint8_t k = 0; k < CRITPROF_KINDS; ++k) {
+        for (critprof_site_t *p = g_sites; p != NULL; p = p->next) {
+            if (p->kind != k) continue;
+
+            critprof_site_t s;
+            uint32_t ps = cp_lock();
+            s = *p;
+            cp_unlock(ps);
+            ESP_LOGI(TAG, "%-7s %s:%u n=%u max=%u cyc (%u us) total=%u us mean=%u cyc",
+                     kind_names[k], s.func, (unsigned)s.line, (unsigned)s.n,
+                     (unsigned)s.max_cyc, (unsigned)(s.max_cyc / TIMEBASE_CYCLES_PER_US),
+                     (unsigned)(s.total_cyc / TIMEBASE_CYCLES_PER_US),
+                     (unsigned)(s.n ? s.total_cyc / s.n : 0));
+        }
+    }
+}
+
+int critprof_worst(uint8_t kind, critprof_site_t *out) {
+    int found = 0;
+    uint32_t ps = cp_lock();
+    for (critprof_site_t *p = g_sites; p != NULL; p = p->next) {
+        if (p->kind == kind && (!found || p->max_cyc > out->max_cyc)) {
+            *out = *p;
+            found = 1;
+        }
+    }
+    cp_unlock(ps);
+    return found;
+}
+
+#endif /* CRITPROF_ENABLE */
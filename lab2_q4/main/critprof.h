@@ -0,0 +1,84 @@
+/*
+ * Critical-section profiler for lab2_q4 (CRITPROF_ENABLE, lab2_config.h).
+ *
+ * On this single core the longest interrupts-off window bounds interrupt
+ * latency and the longest scheduler-suspended window bounds task-switch
+ * latency. The app and trace code open those windows through the macros
+ * below; with CRITPROF_ENABLE each outermost window is timed in CCOUNT cycles
+ * and counted per call site (function and line of the ENTER/SUSPEND_ALL).
+ * Windows nested in one of the same kind count as part of it.
+ *
+ * CRITPROF_ATOMIC() times one __atomic builtin: lx106 has no atomic
+ * instructions, so it is a libgcc call that masks interrupts around the
+ * read-modify-write.
+ *
+ * Windows the kernel opens itself (and the trace hooks that run in them) are
+ * not seen here; TRACE_SELF_TIME measures what the hooks add to those.
+ * Durations come from timebase_cost_now(): CCOUNT on target, host CPU cycles
+ * in the host build (simulated time does not pass inside a window), where
+ * only the cycle counts are meaningful, not the us conversion.
+ */
+
+#ifndef LAB2_CRITPROF_H
+#define LAB2_CRITPROF_H
+
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "lab2_config.h"
+#include "timebase.h"
+
+#define CRITPROF_KIND_CRIT      0   /* taskENTER_CRITICAL: interrupts off */
+#define CRITPROF_KIND_SUSPEND   1   /* vTaskSuspendAll: no task switches */
+#define CRITPROF_KIND_ATOMIC    2   /* __atomic builtin */
+#define CRITPROF_KINDS          3
+
+typedef struct critprof_site {
+    const char           *func;
+    uint16_t              line;
+    uint8_t               kind;
+    uint8_t               linked;       /* on the report list yet */
+    uint32_t              n;
+    uint32_t              max_cyc;
+    uint64_t              total_cyc;
+    struct critprof_site *next;
+} critprof_site_t;
+
+#if CRITPROF_ENABLE
+#define CRITPROF_SITE(kind) \
+    static critprof_site_t critprof_site_ = { __func__, __LINE__, (kind), 0, 0, 0, 0, NULL }
+
+#define CRITPROF_ENTER() \
+    do { CRITPROF_SITE(CRITPROF_KIND_CRIT); taskENTER_CRITICAL(); critprof_enter(&critprof_site_); } while (0)
+#define CRITPROF_EXIT() \
+    do { critprof_exit(CRITPROF_KIND_CRIT); taskEXIT_CRITICAL(); } while (0)
+#define CRITPROF_SUSPEND_ALL() \
+    do { CRITPROF_SITE(CRITPROF_KIND_SUSPEND); vTaskSuspendAll(); critprof_enter(&critprof_site_); } while (0)
+#define CRITPROF_RESUME_ALL() \
+    (critprof_exit(CRITPROF_KIND_SUSPEND), xTaskResumeAll())
+#define CRITPROF_ATOMIC(expr) __extension__ ({                            \
+    CRITPROF_SITE(CRITPROF_KIND_ATOMIC);                                  \
+    uint32_t critprof_c0_ = timebase_cost_now();                          \
+    __typeof__(expr) critprof_v_ = (expr);                                \
+    critprof_atomic(&critprof_site_, timebase_cost_now() - critprof_c0_); \
+    critprof_v_; })
+#else
+#define CRITPROF_ENTER()        taskENTER_CRITICAL()
+#define CRITPROF_EXIT()         taskEXIT_CRITICAL()
+#define CRITPROF_SUSPEND_ALL()  vTaskSuspendAll()
+#define CRITPROF_RESUME_ALL()   xTaskResumeAll()
+#define CRITPROF_ATOMIC(expr)   (expr)
+#endif
+
+/* Behind the macros: right after the window opens / right before it closes */
+void critprof_enter(critprof_site_t *site);
+void critprof_exit(uint8_t kind);
+void critprof_atomic(critprof_site_t *site, uint32_t cycles);
+
+/* Log every site seen so far: count, max, total and mean duration */
+void critprof_report(void);
+
+/* Copy of the site with the longest window of one kind; 0 if none yet */
+int critprof_worst(uint8_t kind, critprof_site_t *out);
+
+#endif /* LAB2_CRITPROF_H */
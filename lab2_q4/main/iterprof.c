@@ -0,0 +1,129 @@
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "trace.h"
+#include "timebase.h"
+#include "critprof.h"
+#include "iterprof.h"
+
+static const char *TAG = "ITER";
+static const char *const comp_names[ITERPROF_COMPONENTS + 1] = {
+    "lock_wait", "lock_held", "log", "busy", "preempt", "delay", "iteration"
+};
+
+typedef struct {
+    const char      *name;
+    uint8_t          task;          /* trace index, set by iterprof_begin() */
+    uint64_t         t_begin;
+    uint64_t         t_mark;        /* timebase_us() at the previous mark */
+    uint64_t         off_mark;      /* g_off_us[task] at the previous mark */
+    uint32_t         cur[ITERPROF_COMPONENTS];      /* this iteration so far */
+    iterprof_stats_t st;
+} iterprof_loop_t;
+
+static iterprof_loop_t g_loops[ITERPROF_MAX_TASKS];
+static int g_nloops = 0;
+
+#if ITERPROF_ENABLE
+
+/* Off-CPU time per task, kept by the switch-in hook (interrupts masked) */
+static uint64_t g_off_us[TRACE_MAX_TASKS];
+static uint64_t g_out_t[TRACE_MAX_TASKS];   /* when the task last left the CPU */
+static uint8_t  g_running = 0;
+
+void iterprof_switched_in(void) {
+    uint8_t me = trace_self_index();
+    uint64_t now = timebase_us();
+
+    /* The outgoing task leaves the CPU as this one takes it */
+    g_out_t[g_running] = now;
+    if (g_out_t[me]) g_off_us[me] += now - g_out_t[me];
+    g_running = me;
+}
+
+int iterprof_register(const char *name) {
+    int id = -1;
+    CRITPROF_ENTER();
+    if (g_nloops < ITERPROF_MAX_TASKS) {
+        id = g_nloops++;
+        memset(&g_loops[id], 0, sizeof(g_loops[0]));
+        g_loops[id].name = name;
+    }
+    CRITPROF_EXIT();
+    return id;
+}
+
+void iterprof_begin(int id) {
+    if (id < 0) return;
+    iterprof_loop_t *l = &g_loops[id];
+    l->task = trace_self_index();
+    l->t_begin = l->t_mark = timebase_us();
+    l->off_mark = g_off_us[l->task];      /* we are running: up to date */
+    memset(l->cur, 0, sizeof(l->cur));
+}
+
+void iterprof_mark(int id, iterprof_comp_t c) {
+    if (id < 0) return;
+    iterprof_loop_t *l = &g_loops[id];
+    uint64_t now = timebase_us();
+    uint64_t off = g_off_us[l->task];
+    uint32_t wall = (uint32_t)(now - l->t_mark);
+    uint32_t away = (uint32_t)(off - l->off_mark);
+
+    if (c == ITERPROF_LOCK_WAIT || c == ITERPROF_DELAY || away > wall) {
+        l->cur[c] += wall;
+    } else {
+        l->cur[c] += wall - away;
+        l->cur[ITERPROF_PREEMPT] += away;
+    }
+    l->t_mark = now;
+    l->off_mark = off;
+}
+
+void iterprof_end(int id) {
+    if (id < 0) return;
+    iterprof_loop_t *l = &g_loops[id];
+    uint32_t total = (uint32_t)(timebase_us() - l->t_begin);
+
+    CRITPROF_ENTER();   /* against a reader's snapshot */
+    iterprof_stats_t *s = &l->st;
+    s->n++;
+    for (int c = 0; c <= ITERPROF_COMPONENTS; ++c) {
+        uint32_t v = (c < ITERPROF_COMPONENTS) ? l->cur[c] : total;
+        s->total_us[c] += v;
+        if (v > s->max_us[c]) s->max_us[c] = v;
+    }
+    CRITPROF_EXIT();
+}
+
+#endif /* ITERPROF_ENABLE */
+
+int iterprof_get(int id, iterprof_stats_t *out) {
+    if (id < 0 || id >= g_nloops) return 0;
+    CRITPROF_ENTER();
+    *out = g_loops[id].st;
+    CRITPROF_EXIT();
+    return 1;
+}
+
+void iterprof_report(void) {
+    static iterprof_stats_t s;
+
+    for (int i = 0; i < g_nloops; ++i) {
+        iterprof_get(i, &s);
+        if (s.n == 0) continue;
+
+        uint64_t whole = s.total_us[ITERPROF_COMPONENTS];
+        ESP_LOGI(TAG, "%s: n=%u mean=%u us max=%u us", g_loops[i].name, (unsigned)s.n,
+                 (unsigned)(whole / s.n), (unsigned)s.max_us[ITERPROF_COMPONENTS]);
+        for (int c = 0; c < ITERPROF_COMPONENTS; ++c) {
+            if (s.total_us[c] == 0) continue;
+            uint32_t pm = whole ? (uint32_t)(s.total_us[c] * 1000 / whole) : 0;
+            ESP_LOGI(TAG, "  %-9s mean=%u us max=%u us share=%u.%u%%", comp_names[c],
+                     (unsigned)(s.total_us[c] / s.n), (unsigned)s.max_us[c],
+                     (unsigned)(pm / 10), (unsigned)(pm % 10));
+        }
+    }
+}
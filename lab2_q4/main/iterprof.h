@@ -0,0 +1,62 @@
+/*
+ * Per-iteration response-time decomposition for lab2_q4 (ITERPROF_ENABLE,
+ * lab2_config.h).
+ *
+ * A task loop brackets one iteration with iterprof_begin()/iterprof_end() and
+ * calls iterprof_mark(id, c) after each phase: the time since the previous
+ * mark is charged to component c. Phases that never block (lock held, logging,
+ * busy-wait) only keep the time the task was on the CPU; the rest, when other
+ * tasks ran, goes to ITERPROF_PREEMPT. Blocking phases (lock wait, delay) keep
+ * their whole wall time. Time off the CPU comes from the switch-in hook.
+ *
+ * Each component's per-iteration sum feeds count, max and total, so the
+ * report gives mean, max and its share of the iteration for every component.
+ */
+
+#ifndef LAB2_ITERPROF_H
+#define LAB2_ITERPROF_H
+
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "lab2_config.h"
+
+#define ITERPROF_MAX_TASKS  2
+
+typedef enum {
+    ITERPROF_LOCK_WAIT,     /* blocked in lockprof_take() */
+    ITERPROF_LOCK_HELD,     /* holding the lock, logging excluded */
+    ITERPROF_LOG,           /* ESP_LOG* formatting and UART */
+    ITERPROF_BUSY,          /* busy-wait */
+    ITERPROF_PREEMPT,       /* ready but another task ran (non-blocking phases) */
+    ITERPROF_DELAY,         /* blocked in vTaskDelay / taskYIELD */
+    ITERPROF_COMPONENTS
+} iterprof_comp_t;
+
+typedef struct {
+    uint32_t n;             /* iterations */
+    uint32_t max_us[ITERPROF_COMPONENTS + 1];   /* [ITERPROF_COMPONENTS] = whole iteration */
+    uint64_t total_us[ITERPROF_COMPONENTS + 1];
+} iterprof_stats_t;
+
+#if ITERPROF_ENABLE
+/* Decompose a task loop; returns its id for the calls below, -1 if full */
+int  iterprof_register(const char *name);
+
+/* From the task itself: iteration starts / phase ended / iteration ends */
+void iterprof_begin(int id);
+void iterprof_mark(int id, iterprof_comp_t c);
+void iterprof_end(int id);
+#else
+#define iterprof_register(name)     (-1)
+#define iterprof_begin(id)          ((void)(id))
+#define iterprof_mark(id, c)        ((void)(id))
+#define iterprof_end(id)            ((void)(id))
+#endif
+
+/* Snapshot of one loop's statistics; 0 if no such id */
+int  iterprof_get(int id, iterprof_stats_t *out);
+
+/* Log mean, max and share of every component for every loop */
+void iterprof_report(void);
+
+#endif /* LAB2_ITERPROF_H */
@@ -0,0 +1,85 @@
+/*
+ * Build-time switches of the lab2_q4 app: which recorder sits behind the
+ * kernel hooks, which profilers are compiled in, and the binary trace's
+ * event codes. FreeRTOSConfig.h includes this to compose its trace hooks,
+ * so the kernel and the app see the same values.
+ */
+#ifndef LAB2_CONFIG_H
+#define LAB2_CONFIG_H
+
+/* ===== Tracing ===== */
+/* Recorder behind the hooks: OFF compiles every hook out, STRING is the old
+   snprintf BlockEvt ring (block events only, overhead baseline), BINARY is
+   the trace.c double-buffered record */
+#define TRACE_MODE_OFF      0
+#define TRACE_MODE_STRING   1
+#define TRACE_MODE_BINARY   2
+#ifndef TRACE_MODE
+#define TRACE_MODE          TRACE_MODE_BINARY
+#endif
+
+/* Categories: 0 leaves the kernel's empty default macro in place (zero cost) */
+#define TRACE_CAT_BLOCK     (TRACE_MODE != TRACE_MODE_OFF)      /* delay / block on queue, sem, mutex */
+#define TRACE_CAT_SWITCH    (TRACE_MODE == TRACE_MODE_BINARY)   /* context switch in/out, task made ready */
+#define TRACE_CAT_LOCK      (TRACE_MODE == TRACE_MODE_BINARY)   /* successful take/give (queue receive/send, recursive mutex) */
+#define TRACE_CAT_PI        (TRACE_MODE == TRACE_MODE_BINARY)   /* priority inheritance boost / restore */
+
+/* ===== Profilers ===== */
+/* Priority-inversion monitor (pimon.c): also needs the switch-in hook */
+#ifndef PIMON_ENABLE
+#define PIMON_ENABLE        1
+#endif
+
+/* PC-sampling profiler (pcprof.c): samples on every tick, or with PCPROF_HZ
+   set from the FRC1 hardware timer at that rate instead */
+#ifndef PCPROF_ENABLE
+#define PCPROF_ENABLE       0
+#endif
+#ifndef PCPROF_HZ
+#define PCPROF_HZ           0
+#endif
+
+/* Critical-section profiler (critprof.c): interrupts-off, scheduler-suspended
+   and atomic windows opened by the app and trace code, per call site */
+#ifndef CRITPROF_ENABLE
+#define CRITPROF_ENABLE     0
+#endif
+
+/* Lock-held blocking-call detector (lockio.c): logging, delays and queue
+   operations made while the caller holds a lockprof-registered lock */
+#ifndef LOCKIO_ENABLE
+#define LOCKIO_ENABLE       0
+#endif
+
+/* Response-time decomposition of the LED task loops (iterprof.c): also
+   needs the switch-in hook */
+#ifndef ITERPROF_ENABLE
+#define ITERPROF_ENABLE     0
+#endif
+
+/* Execution time of each task loop iteration, blocked and preempted time
+   left out (components/wcet): also needs the switch-in hook */
+#ifndef WCET_ENABLE
+#define WCET_ENABLE         0
+#endif
+
+/* ===== Binary trace ===== */
+/* Event codes stored in the binary trace (names resolved in trace.c) */
+#define TRACE_EVT_DELAY         1
+#define TRACE_EVT_DELAY_UNTIL   2
+#define TRACE_EVT_BLOCK_Q_RECV  3
+#define TRACE_EVT_BLOCK_Q_PEEK  4
+#define TRACE_EVT_SWITCH_IN     5
+#define TRACE_EVT_SWITCH_OUT    6
+#define TRACE_EVT_TAKE          7   /* queue receive == semaphore/mutex take */
+#define TRACE_EVT_GIVE          8   /* queue send == semaphore/mutex give */
+#define TRACE_EVT_TAKE_RECURSIVE 9
+#define TRACE_EVT_GIVE_RECURSIVE 10
+#define TRACE_EVT_PI_INHERIT    11  /* obj = boosted holder, arg = new priority */
+#define TRACE_EVT_PI_DISINHERIT 12  /* obj = holder, arg = restored priority */
+#define TRACE_EVT_READY         13  /* obj = task moved to the ready list */
+#define TRACE_EVT_LOCK_WAIT     14  /* lockprof: obj = lock, arg = log2 bucket of the wait (us) */
+#define TRACE_EVT_LOCK_HOLD     15  /* lockprof: obj = lock, arg = log2 bucket of the hold (us) */
+#define TRACE_EVT_COUNT         16  /* one past the last code: sizes per-event counters */
+
+#endif /* LAB2_CONFIG_H */
@@ -0,0 +1,162 @@
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "trace.h"
+#include "critprof.h"
+#include "timebase.h"
+#include "lockprof.h"
+#include "lockio.h"
+
+#if LOCKIO_ENABLE
+
+static const char *TAG = "LOCKIO";
+
+typedef struct {
+    SemaphoreHandle_t lock;
+    uint32_t          take_pc;
+    const void       *what;         /* log format string or kernel object */
+    uint8_t           kind;         /* LOCKIO_KIND_LOG or TRACE_EVT_* */
+    uint8_t           task;
+    uint32_t          n;
+    uint32_t          held_max_us;  /* lock already held this long at the call */
+    uint32_t          hold_max_us;  /* longest whole hold containing the call */
+} lockio_site_t;
+
+typedef struct {
+    SemaphoreHandle_t h;
+    uint64_t          t_acq;
+    uint32_t          take_pc;
+    uint32_t          sites;        /* bit i: g_sites[i] happened in this hold */
+} lockio_held_t;
+
+static lockio_site_t g_sites[LOCKIO_MAX_SITES];
+static uint32_t g_nsites = 0;
+static uint32_t g_dropped = 0;     /* calls not recorded: site table full */
+
+/* Locks each task holds, innermost last */
+static lockio_held_t g_held[TRACE_MAX_TASKS][LOCKPROF_MAX_LOCKS];
+static uint8_t g_nheld[TRACE_MAX_TASKS];
+
+static vprintf_like_t g_prev_vprintf = NULL;
+
+/* Caller excludes other tasks and the hooks (critical section, or is a hook) */
+static void note(uint8_t me, uint8_t kind, const void *what) {
+    lockio_held_t *l = &g_held[me][g_nheld[me] - 1];
+    uint32_t held_us = (uint32_t)(timebase_us() - l->t_acq);
+    uint32_t i;
+
+    for (i = 0; i < g_nsites; ++i) {
+        lockio_site_t *s = &g_sites[i];
+        if (s->kind == kind && s->what == what && s->lock == l->h &&
+            s->take_pc == l->take_pc && s->task == me)
+            break;
+    }
+    if (i == g_nsites) {
+        if (g_nsites == LOCKIO_MAX_SITES) {
+            g_dropped++;
+            return;
+        }
+        g_sites[i] = (lockio_site_t){ .lock = l->h, .take_pc = l->take_pc, .what = what,
+                                      .kind = kind, .task = me };
+        g_nsites++;
+    }
+
+    lockio_site_t *s = &g_sites[i];
+    s->n++;
+    if (held_us > s->held_max_us) s->held_max_us = held_us;
+    l->sites |= 1u << i;
+}
+
+/* esp_log_set_vprintf() hook: runs in the logging task before the UART write */
+static int log_hook(const char *fmt, va_list ap) {
+    uint8_t me = trace_self_index();
+    if (g_nheld[me]) {
+        CRITPROF_ENTER();
+        if (g_nheld[me]) note(me, LOCKIO_KIND_LOG, fmt);
+        CRITPROF_EXIT();
+    }
+    return g_prev_vprintf ? g_prev_vprintf(fmt, ap) : 0;
+}
+
+void lockio_start(void) {
+    g_prev_vprintf = esp_log_set_vprintf(log_hook);
+}
+
+void lockio_acquired(SemaphoreHandle_t h, uint32_t take_pc) {
+    uint8_t me = trace_self_index();
+
+    CRITPROF_ENTER();
+    if (g_nheld[me] < LOCKPROF_MAX_LOCKS) {
+        g_held[me][g_nheld[me]++] = (lockio_held_t){ .h = h, .t_acq = timebase_us(),
+                                                     .take_pc = take_pc };
+    }
+    CRITPROF_EXIT();
+}
+
+void lockio_released(SemaphoreHandle_t h) {
+    uint8_t me = trace_self_index();
+    uint64_t now = timebase_us();
+
+    CRITPROF_ENTER();
+    for (int k = g_nheld[me] - 1; k >= 0; --k) {
+        lockio_held_t *l = &g_held[me][k];
+        if (l->h != h) continue;
+
+        /* Charge the whole hold to every site that happened inside it */
+        uint32_t hold_us = (uint32_t)(now - l->t_acq);
+        for (uint32_t m = l->sites; m; m &= m - 1) {
+            lockio_site_t *s = &g_sites[__builtin_ctz(m)];
+            if (hold_us > s->hold_max_us) s->hold_max_us = hold_us;
+        }
+        memmove(l, l + 1, (size_t)(g_nheld[me] - 1 - k) * sizeof(*l));
+        g_nheld[me]--;
+        break;
+    }
+    CRITPROF_EXIT();
+}
+
+void lockio_kernel_call(uint32_t code, const void *obj) {
+    /* Kernel hook: already atomic with respect to tasks and the other hooks */
+    uint8_t me = trace_self_index();
+    if (g_nheld[me]) note(me, (uint8_t)code, obj);
+}
+
+/* The text of an ESP_LOG* format: drop the "I (%u) %s: " prefix and the
+   colour / newline suffix the macro wraps it in */
+static void log_text(const char *fmt, char *out, size_t size) {
+    const char *p = strstr(fmt, "%s: ");
+    p = p ? p + 4 : fmt;
+    size_t n = strcspn(p, "\033\n");
+    if (n >= size) n = size - 1;
+    memcpy(out, p, n);
+    out[n] = '\0';
+}
+
+void lockio_report(void) {
+    static char what[48];
+    static lockio_site_t s;
+
+    for (uint32_t i = 0; i < g_nsites; ++i) {
+        CRITPROF_ENTER();
+        s = g_sites[i];
+        CRITPROF_EXIT();
+
+        if (s.kind == LOCKIO_KIND_LOG)
+            log_text((const char *)s.what, what, sizeof(what));
+        else
+            snprintf(what, sizeof(what), "%s %p", trace_evt_name(s.kind), s.what);
+        ESP_LOGW(TAG, "%s holds %s (taken at %08x): %s \"%s\" n=%u held=%u us hold_max=%u us",
+                 trace_task_name(s.task), lockprof_name(s.lock), (unsigned)s.take_pc,
+                 s.kind == LOCKIO_KIND_LOG ? "log" : "kernel", what, (unsigned)s.n,
+                 (unsigned)s.held_max_us, (unsigned)s.hold_max_us);
+    }
+    if (g_dropped)
+        ESP_LOGW(TAG, "%u calls not recorded: more than %u sites", (unsigned)g_dropped,
+                 (unsigned)LOCKIO_MAX_SITES);
+}
+
+#endif /* LOCKIO_ENABLE */
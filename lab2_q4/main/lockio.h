@@ -0,0 +1,44 @@
+/*
+ * Lock-held blocking-call detector for lab2_q4 (LOCKIO_ENABLE, lab2_config.h).
+ *
+ * Flags calls that can take milliseconds while the caller holds a lock
+ * registered with lockprof, and so stretch every other task's wait:
+ *   - ESP_LOG* output (UART at console baud), via esp_log_set_vprintf()
+ *   - vTaskDelay / vTaskDelayUntil and blocking on a queue (trace hooks)
+ *   - queue, semaphore or mutex send/receive, e.g. taking a second lock
+ * A site is the held lock, where it was taken (lockprof_take's return
+ * address), the running task and the call: the log format string or the
+ * kernel event and its object. Each keeps a count, how long the lock had
+ * been held at the call, and the longest hold it was part of.
+ */
+
+#ifndef LAB2_LOCKIO_H
+#define LAB2_LOCKIO_H
+
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "lab2_config.h"
+
+#define LOCKIO_MAX_SITES    32      /* one bit each in a hold's site mask */
+#define LOCKIO_KIND_LOG     0       /* kernel calls use their TRACE_EVT_* code */
+
+#if LOCKIO_ENABLE
+/* Called by lockprof */
+void lockio_acquired(SemaphoreHandle_t h, uint32_t take_pc);   /* calling task now holds h */
+void lockio_released(SemaphoreHandle_t h);                     /* calling task is giving h */
+#else
+#define lockio_acquired(h, take_pc) ((void)0)
+#define lockio_released(h)          ((void)0)
+#endif
+
+/* Install the log hook; call once at boot */
+void lockio_start(void);
+
+/* From the delay / queue trace hooks; must not block */
+void lockio_kernel_call(uint32_t code, const void *obj);
+
+/* Log every site seen so far */
+void lockio_report(void);
+
+#endif /* LAB2_LOCKIO_H */
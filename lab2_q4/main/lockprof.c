@@ -0,0 +1,146 @@
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "trace.h"
+#include "lockprof.h"
+#include "pimon.h"
+#include "lockio.h"
+
+static const char *TAG = "LOCKPROF";
+
+typedef struct {
+    SemaphoreHandle_t h;
+    const char       *name;
+    uint64_t          t_acq;                /* timebase_us() when the current holder got it */
+    uint8_t           holder;               /* trace index of the current holder */
+    lockprof_stat_t   per_task[TRACE_MAX_TASKS];
+} lockprof_lock_t;
+
+static lockprof_lock_t g_locks[LOCKPROF_MAX_LOCKS];
+static int g_nlocks = 0;
+
+static lockprof_lock_t *find_lock(SemaphoreHandle_t h) {
+    for (int i = 0; i < g_nlocks; ++i)
+        if (g_locks[i].h == h) return &g_locks[i];
+    return NULL;
+}
+
+static inline int bucket_of(uint32_t us) {
+    int b = us ? 32 - __builtin_clz(us) : 0;
+    return (b < LOCKPROF_BUCKETS) ? b : LOCKPROF_BUCKETS - 1;
+}
+
+void lockprof_register(SemaphoreHandle_t h, const char *name) {
+    configASSERT(g_nlocks < LOCKPROF_MAX_LOCKS);
+    lockprof_lock_t *l = &g_locks[g_nlocks];
+    memset(l, 0, sizeof(*l));
+    l->h = h;
+    l->name = name;
+    g_nlocks++;
+    pimon_register(h, name);
+}
+
+BaseType_t lockprof_take(SemaphoreHandle_t h, TickType_t timeout) {
+    lockprof_lock_t *l = find_lock(h);
+    if (l == NULL) return xSemaphoreTake(h, timeout);
+
+    uint64_t t0 = timebase_us();
+    int contended = 0;
+    BaseType_t ok = xSemaphoreTake(h, 0);
+    if (ok != pdTRUE && timeout != 0) {
+        contended = 1;
+        pimon_wait_begin(h);
+        ok = xSemaphoreTake(h, timeout);
+        if (ok != pdTRUE) pimon_wait_cancel(h);
+    }
+    if (ok != pdTRUE) return ok;
+    pimon_acquired(h);
+    lockio_acquired(h, (uint32_t)(uintptr_t)__builtin_return_address(0));
+
+    uint64_t t1 = timebase_us();
+    uint32_t wait_us = (uint32_t)(t1 - t0);
+    uint8_t me = trace_self_index();
+    lockprof_stat_t *s = &l->per_task[me];
+
+    s->acq++;
+    s->contended += contended;
+    s->wait_hist[bucket_of(wait_us)]++;
+    if (wait_us > s->wait_max_us) s->wait_max_us = wait_us;
+    trace_mark(TRACE_EVT_LOCK_WAIT, h, wait_us);     /* lets a trigger catch long waits */
+
+    l->holder = me;
+    l->t_acq = timebase_us();
+    return ok;
+}
+
+BaseType_t lockprof_give(SemaphoreHandle_t h) {
+    lockprof_lock_t *l = find_lock(h);
+    if (l != NULL) {
+        /* Account before the give: afterwards another task may own the lock */
+        uint32_t hold_us = (uint32_t)(timebase_us() - l->t_acq);
+        lockprof_stat_t *s = &l->per_task[l->holder];
+        s->hold_hist[bucket_of(hold_us)]++;
+        if (hold_us > s->hold_max_us) s->hold_max_us = hold_us;
+        trace_mark(TRACE_EVT_LOCK_HOLD, h, hold_us);
+        pimon_released(h);
+        lockio_released(h);
+    }
+    return xSemaphoreGive(h);
+}
+
+static void dump_hist(const char *what, const uint32_t *hist) {
+    static char line[LOCKPROF_BUCKETS * 11 + 1];
+    int n = 0;
+    for (int b = 0; b < LOCKPROF_BUCKETS; ++b)
+        n += snprintf(line + n, sizeof(line) - n, " %u", (unsigned)hist[b]);
+    ESP_LOGI(TAG, "    %s us log2 buckets:%s", what, line);
+}
+
+void lockprof_dump(void) {
+    for (int i = 0; i < g_nlocks; ++i) {
+        lockprof_lock_t *l = &g_locks[i];
+        for (int t = 0; t < TRACE_MAX_TASKS; ++t) {
+            lockprof_stat_t *s = &l->per_task[t];
+            if (s->acq == 0 && s->hold_max_us == 0) continue;
+            ESP_LOGI(TAG, "%s/%s: acq=%u contended=%u wait_max=%u us hold_max=%u us",
+                     l->name, trace_task_name((uint8_t)t), (unsigned)s->acq,
+                     (unsigned)s->contended, (unsigned)s->wait_max_us, (unsigned)s->hold_max_us);
+            dump_hist("wait", s->wait_hist);
+            dump_hist("hold", s->hold_hist);
+        }
+    }
+}
+
+const char *lockprof_name(SemaphoreHandle_t h) {
+    lockprof_lock_t *l = find_lock(h);
+    return l ? l->name : "?";
+}
+
+SemaphoreHandle_t lockprof_find(const char *name) {
+    for (int i = 0; i < g_nlocks; ++i)
+        if (strcmp(g_locks[i].name, name) == 0) return g_locks[i].h;
+    return NULL;
+}
+
+int lockprof_get(SemaphoreHandle_t h, uint8_t task, lockprof_stat_t *out) {
+    lockprof_lock_t *l = find_lock(h);
+    if (l == NULL || task >= TRACE_MAX_TASKS) return 0;
+    *out = l->per_task[task];
+    return 1;
+}
+
+uint32_t lockprof_hist_pct(const uint32_t hist[LOCKPROF_BUCKETS], unsigned pct) {
+    uint32_t total = 0, seen = 0;
+    for (int b = 0; b < LOCKPROF_BUCKETS; ++b) total += hist[b];
+    if (total == 0) return 0;
+
+    uint32_t want = (uint32_t)(((uint64_t)total * pct + 99) / 100);
+    for (int b = 0; b < LOCKPROF_BUCKETS - 1; ++b) {
+        seen += hist[b];
+        if (seen >= want) return b ? (1u << b) - 1 : 0;
+    }
+    return UINT32_MAX;          /* the last bucket has no upper end */
+}
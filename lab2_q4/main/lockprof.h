@@ -0,0 +1,52 @@
+/*
+ * Lock contention profiler for lab2_q4.
+ *
+ * lockprof_take()/lockprof_give() wrap xSemaphoreTake()/xSemaphoreGive() and
+ * keep, per lock and per task (trace index), acquisition and contention counts
+ * plus log2-bucketed wait and hold histograms in microseconds.
+ */
+
+#ifndef LAB2_LOCKPROF_H
+#define LAB2_LOCKPROF_H
+
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+#define LOCKPROF_MAX_LOCKS  2
+#define LOCKPROF_BUCKETS    16      /* [0], [1,2), [2,4) ... [16.4 ms, inf) us */
+#define LOCKPROF_OPEN_US    (1u << (LOCKPROF_BUCKETS - 2))  /* last bucket's lower end */
+
+typedef struct {
+    uint32_t acq;                           /* successful takes */
+    uint32_t contended;                     /* takes that had to block */
+    uint32_t wait_max_us;
+    uint32_t hold_max_us;
+    uint32_t wait_hist[LOCKPROF_BUCKETS];
+    uint32_t hold_hist[LOCKPROF_BUCKETS];
+} lockprof_stat_t;
+
+/* Profile h under name; call once after creating the lock */
+void lockprof_register(SemaphoreHandle_t h, const char *name);
+
+/* Drop-in replacements; unregistered locks pass straight through */
+BaseType_t lockprof_take(SemaphoreHandle_t h, TickType_t timeout);
+BaseType_t lockprof_give(SemaphoreHandle_t h);
+
+/* Handle registered under name, or NULL */
+SemaphoreHandle_t lockprof_find(const char *name);
+
+/* Name h was registered under, or "?" */
+const char *lockprof_name(SemaphoreHandle_t h);
+
+/* Log every lock x task row (counts, max, histograms) */
+void lockprof_dump(void);
+
+/* Copy of one lock x task row (task = trace index); 0 if h is not profiled */
+int lockprof_get(SemaphoreHandle_t h, uint8_t task, lockprof_stat_t *out);
+
+/* Upper bound (us) of the bucket holding the pct-th percentile of hist;
+   UINT32_MAX if that is the open-ended last one (>= LOCKPROF_OPEN_US) */
+uint32_t lockprof_hist_pct(const uint32_t hist[LOCKPROF_BUCKETS], unsigned pct);
+
+#endif /* LAB2_LOCKPROF_H */
@@ -0,0 +1,109 @@
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "trace.h"
+#include "critprof.h"
+#include "pcprof.h"
+#if PCPROF_ENABLE && PCPROF_HZ && !defined(LAB2_HOST)
+#include "driver/hw_timer.h"
+#endif
+
+#if PCPROF_ENABLE
+
+_Static_assert((PCPROF_RING & (PCPROF_RING - 1)) == 0, "ring index is masked");
+
+#define PCPROF_PER_LINE 16      /* PCP: samples per line */
+
+#ifdef LAB2_HOST
+/* host/sim.c: the code simulated time was spent in when the tick fell due */
+void pcprof_interrupted(uint32_t *pc, uint32_t *caller);
+#define PCPROF_CALLER   1
+#define PCPROF_RATE     configTICK_RATE_HZ      /* no FRC1: always the tick */
+#else
+static inline void pcprof_interrupted(uint32_t *pc, uint32_t *caller) {
+    /* lx106 has a single interrupt level below NMI: EPC1 is where it hit */
+    __asm__ __volatile__("rsr %0, epc1" : "=a"(*pc));
+    *caller = 0;
+}
+#define PCPROF_CALLER   0
+#define PCPROF_RATE     (PCPROF_HZ ? PCPROF_HZ : configTICK_RATE_HZ)
+#endif
+
+static const char *TAG = "PCPROF";
+
+/* Single producer (the interrupt), single consumer (pcprof_dump): a full
+   ring drops new samples and counts them rather than overwriting */
+static uint32_t g_pc[PCPROF_RING];
+#if PCPROF_CALLER
+static uint32_t g_caller[PCPROF_RING];
+#endif
+static uint8_t g_task[PCPROF_RING];
+static volatile uint32_t g_head = 0;
+static volatile uint32_t g_tail = 0;
+static volatile uint32_t g_lost = 0;
+
+void pcprof_sample(void) {
+    uint32_t h = g_head, pc, caller;
+    if (h - g_tail >= PCPROF_RING) {
+        g_lost++;
+        return;
+    }
+
+    pcprof_interrupted(&pc, &caller);
+    g_pc[h & (PCPROF_RING - 1)] = pc;
+#if PCPROF_CALLER
+    g_caller[h & (PCPROF_RING - 1)] = caller;
+#else
+    (void)caller;
+#endif
+    g_task[h & (PCPROF_RING - 1)] = trace_self_index();
+    g_head = h + 1;
+}
+
+#if PCPROF_HZ && !defined(LAB2_HOST)
+static void pcprof_timer_isr(void *arg) {
+    (void)arg;
+    pcprof_sample();
+}
+#endif
+
+void pcprof_start(void) {
+#if PCPROF_HZ && !defined(LAB2_HOST)
+    hw_timer_init(pcprof_timer_isr, NULL);
+    hw_timer_alarm_us(1000000 / PCPROF_HZ, true);
+#endif
+    ESP_LOGI(TAG, "sampling at %u Hz, %u-sample ring", (unsigned)PCPROF_RATE, (unsigned)PCPROF_RING);
+}
+
+void pcprof_dump(void) {
+    static char line[4 + PCPROF_PER_LINE * 18 + 1];
+
+    /* Masks the sampling interrupt, so no sample or loss is half-counted */
+    CRITPROF_ENTER();
+    uint32_t t = g_tail, h = g_head, lost = g_lost;
+    g_lost = 0;
+    CRITPROF_EXIT();
+
+    trace_dump_tasks();
+    printf("PCH:%u,%u,%u\n", (unsigned)PCPROF_RATE, (unsigned)(h - t), (unsigned)lost);
+    while (t != h) {
+        int n = 4;
+        memcpy(line, "PCP:", 4);
+        for (int k = 0; k < PCPROF_PER_LINE && t != h; ++k, ++t) {
+            uint32_t i = t & (PCPROF_RING - 1);
+#if PCPROF_CALLER
+            uint32_t caller = g_caller[i];
+#else
+            uint32_t caller = 0;
+#endif
+            n += snprintf(line + n, sizeof(line) - n, "%02x%08x%08x",
+                          (unsigned)g_task[i], (unsigned)g_pc[i], (unsigned)caller);
+        }
+        puts(line);
+    }
+    g_tail = h;     /* only now may the interrupt reuse those slots */
+}
+
+#endif /* PCPROF_ENABLE */
@@ -0,0 +1,36 @@
+/*
+ * Statistical PC-sampling profiler for lab2_q4 (PCPROF_ENABLE, lab2_config.h).
+ *
+ * A timer interrupt records the PC it interrupted (EPC1) and the running
+ * task's trace index into a PCPROF_RING-sample ring. It is the tick
+ * (traceTASK_INCREMENT_TICK) by default, or FRC1 at PCPROF_HZ: a rate that is
+ * not a multiple of the tick keeps tick-driven work from being sampled in
+ * lockstep. Code that runs with interrupts masked is never interrupted, so
+ * its time lands on the instruction that unmasks them.
+ *
+ * The status task drains the ring as text for tools/pcprof, which symbolises
+ * the samples against the build's ELF:
+ *   PCH:<hz>,<n>,<lost>           n samples follow, lost since the last dump
+ *   PCP:<tt><pppppppp><cccccccc>  16 per line: task index, PC, caller PC
+ * plus the TRT task lines. The caller is only known in the host build
+ * (host/sim.c); on target it is 0.
+ */
+
+#ifndef LAB2_PCPROF_H
+#define LAB2_PCPROF_H
+
+#include <stdint.h>
+#include "lab2_config.h"
+
+#define PCPROF_RING     256     /* samples (power of two); ~2.5 s at the tick rate */
+
+/* Start the FRC1 timer if PCPROF_HZ is set; the tick needs no setup */
+void pcprof_start(void);
+
+/* Record one sample: from the sampling interrupt only */
+void pcprof_sample(void);
+
+/* Print the samples taken since the previous call and empty the ring */
+void pcprof_dump(void);
+
+#endif /* LAB2_PCPROF_H */
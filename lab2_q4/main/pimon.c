@@ -0,0 +1,263 @@
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "trace.h"
+#include "critprof.h"
+#include "pimon.h"
+
+static const char *TAG = "PIMON";
+
+static pimon_stats_t g_stats;
+static pimon_episode_t g_hist[PIMON_HISTORY];
+static uint32_t g_hist_n = 0;
+static pimon_blame_t g_blame[PIMON_BLAME_SLOTS];
+static int g_nblame = 0;
+static uint64_t g_blame_lost_us = 0;   /* table full: charged to no row */
+
+#if PIMON_ENABLE
+
+typedef struct {
+    SemaphoreHandle_t h;
+    const char *name;
+    uint8_t  held, holder;          /* trace index of the holder */
+    uint8_t  waiting, waiter;       /* trace index of the blocked task */
+    uint8_t  inverted, interferer;  /* an M task is on the CPU right now */
+    uint64_t wait_t0;               /* timebase_us(): waiter blocked */
+    uint64_t inv_t0;                /* timebase_us(): current inverted stretch began */
+    uint32_t inv_us;                /* inverted time in this wait so far */
+    uint32_t waiters;               /* blame: bit per task waiting for it */
+} pimon_lock_t;
+
+static pimon_lock_t g_locks[PIMON_MAX_LOCKS];
+static int g_nlocks = 0;
+
+static uint8_t  g_on_cpu = 0;       /* trace index of the running task */
+static uint64_t g_seg_t0 = 0;       /* timebase_us() of the last blame flush */
+
+static pimon_lock_t *find_lock(SemaphoreHandle_t h) {
+    for (int i = 0; i < g_nlocks; ++i)
+        if (g_locks[i].h == h) return &g_locks[i];
+    return NULL;
+}
+
+/* Open or close the inverted stretch of l for the task now on the CPU */
+static void update(pimon_lock_t *l, uint8_t running, uint64_t now) {
+    if (l->inverted) {
+        l->inv_us += (uint32_t)(now - l->inv_t0);
+        l->inverted = 0;
+    }
+    if (!l->waiting || !l->held) return;
+
+    UBaseType_t p  = trace_task_prio(running);
+    UBaseType_t pl = trace_task_prio(l->holder);
+    UBaseType_t ph = trace_task_prio(l->waiter);
+    if (running != l->holder && running != l->waiter && p > pl && p < ph) {
+        l->inverted = 1;
+        l->interferer = running;
+        l->inv_t0 = now;
+    }
+}
+
+static void blame_add(uint8_t waiter, uint8_t holder, uint8_t interferer, uint32_t us) {
+    int i;
+    for (i = 0; i < g_nblame; ++i) {
+        pimon_blame_t *b = &g_blame[i];
+        if (b->waiter == waiter && b->holder == holder && b->interferer == interferer) break;
+    }
+    if (i == g_nblame) {
+        if (g_nblame == PIMON_BLAME_SLOTS) {
+            g_blame_lost_us += us;
+            return;
+        }
+        g_blame[i] = (pimon_blame_t){ .waiter = waiter, .holder = holder, .interferer = interferer };
+        g_nblame++;
+    }
+    g_blame[i].n++;
+    g_blame[i].us += us;
+}
+
+/* Charge the time since the last flush to every waiting task, with each
+   lock's holder as it was over that stretch; interrupts masked by caller */
+static void blame_flush(uint64_t now) {
+    uint32_t us = (uint32_t)(now - g_seg_t0);
+    g_seg_t0 = now;
+    if (us == 0) return;
+
+    for (int i = 0; i < g_nlocks; ++i) {
+        pimon_lock_t *l = &g_locks[i];
+        uint8_t holder = l->held ? l->holder : PIMON_NO_HOLDER;
+        for (uint32_t m = l->waiters; m; m &= m - 1)
+            blame_add((uint8_t)__builtin_ctz(m), holder, g_on_cpu, us);
+    }
+}
+
+void pimon_switched_in(void) {
+    /* Interrupts are masked inside vTaskSwitchContext() */
+    uint8_t running = trace_self_index();
+    uint64_t now = timebase_us();
+    blame_flush(now);
+    g_on_cpu = running;
+    for (int i = 0; i < g_nlocks; ++i)
+        update(&g_locks[i], running, now);
+}
+
+void pimon_register(SemaphoreHandle_t h, const char *name) {
+    configASSERT(g_nlocks < PIMON_MAX_LOCKS);
+    memset(&g_locks[g_nlocks], 0, sizeof(g_locks[0]));
+    g_locks[g_nlocks].h = h;
+    g_locks[g_nlocks].name = name;
+    g_nlocks++;
+}
+
+void pimon_wait_begin(SemaphoreHandle_t h) {
+    pimon_lock_t *l = find_lock(h);
+    if (l == NULL) return;
+    uint8_t me = trace_self_index();
+
+    CRITPROF_ENTER();
+    blame_flush(timebase_us());
+    l->waiters |= 1u << me;
+    /* Keep the highest-priority waiter: it is the one that can be inverted */
+    if (!l->waiting || trace_task_prio(me) > trace_task_prio(l->waiter)) {
+        l->waiting = 1;
+        l->waiter = me;
+        l->wait_t0 = timebase_us();
+        l->inv_us = 0;
+        l->inverted = 0;
+    }
+    CRITPROF_EXIT();
+}
+
+void pimon_acquired(SemaphoreHandle_t h) {
+    pimon_lock_t *l = find_lock(h);
+    if (l == NULL) return;
+    uint8_t me = trace_self_index();
+    uint64_t now = timebase_us();
+    pimon_episode_t ep = { 0 };
+
+    CRITPROF_ENTER();
+    blame_flush(now);
+    l->waiters &= ~(1u << me);
+    uint8_t prev = l->holder;
+    if (l->waiting && l->waiter == me) {
+        if (l->inverted) l->inv_us += (uint32_t)(now - l->inv_t0);
+        if (l->inv_us) {
+            ep.waiter = me;
+            ep.holder = prev;
+            ep.interferer = l->interferer;
+            ep.inverted_us = l->inv_us;
+            ep.wait_us = (uint32_t)(now - l->wait_t0);
+        }
+        l->waiting = 0;
+        l->inverted = 0;
+    }
+    l->held = 1;
+    l->holder = me;
+
+    if (ep.inverted_us) {
+        g_stats.episodes++;
+        g_stats.total_us += ep.inverted_us;
+        if (ep.inverted_us > g_stats.worst_us) {
+            g_stats.worst_us = ep.inverted_us;
+            g_stats.worst = ep;
+        }
+        g_hist[g_hist_n++ % PIMON_HISTORY] = ep;
+    }
+    CRITPROF_EXIT();
+}
+
+void pimon_released(SemaphoreHandle_t h) {
+    pimon_lock_t *l = find_lock(h);
+    if (l == NULL) return;
+
+    CRITPROF_ENTER();
+    uint64_t now = timebase_us();
+    blame_flush(now);
+    if (l->inverted) {
+        l->inv_us += (uint32_t)(now - l->inv_t0);
+        l->inverted = 0;
+    }
+    l->held = 0;
+    CRITPROF_EXIT();
+}
+
+void pimon_wait_cancel(SemaphoreHandle_t h) {
+    pimon_lock_t *l = find_lock(h);
+    if (l == NULL) return;
+    uint8_t me = trace_self_index();
+
+    CRITPROF_ENTER();
+    blame_flush(timebase_us());
+    l->waiters &= ~(1u << me);
+    if (l->waiting && l->waiter == me) {
+        l->waiting = 0;
+        l->inverted = 0;
+    }
+    CRITPROF_EXIT();
+}
+
+#endif /* PIMON_ENABLE */
+
+void pimon_get_stats(pimon_stats_t *out) {
+    CRITPROF_ENTER();
+    *out = g_stats;
+    CRITPROF_EXIT();
+}
+
+int pimon_blame(pimon_blame_t *out, int max) {
+    CRITPROF_ENTER();
+    int n = (g_nblame < max) ? g_nblame : max;
+    memcpy(out, g_blame, (size_t)n * sizeof(*out));
+    CRITPROF_EXIT();
+    return n;
+}
+
+static const char *holder_name(uint8_t t) {
+    return (t == PIMON_NO_HOLDER) ? "(free)" : trace_task_name(t);
+}
+
+static void dump_blame(void) {
+    static pimon_blame_t b[PIMON_BLAME_SLOTS];
+    int n = pimon_blame(b, PIMON_BLAME_SLOTS);
+
+    /* Grouped by waiter, then holder: one wait's breakdown reads together */
+    for (uint8_t w = 0; w < TRACE_MAX_TASKS; ++w) {
+        for (int i = 0; i < n; ++i) {
+            if (b[i].waiter != w) continue;
+            for (int j = i; j < n; ++j) {
+                if (b[j].waiter != w || b[j].holder != b[i].holder) continue;
+                ESP_LOGI(TAG, "  blame: %s waiting, %s holding: %s ran %llu us (%u stretches)",
+                         trace_task_name(w), holder_name(b[j].holder),
+                         trace_task_name(b[j].interferer), (unsigned long long)b[j].us,
+                         (unsigned)b[j].n);
+                b[j].waiter = PIMON_NO_HOLDER;      /* printed */
+            }
+        }
+    }
+    if (g_blame_lost_us)
+        ESP_LOGI(TAG, "  blame: %llu us not attributed (more than %d rows)",
+                 (unsigned long long)g_blame_lost_us, PIMON_BLAME_SLOTS);
+}
+
+void pimon_dump(void) {
+    pimon_stats_t s;
+    pimon_get_stats(&s);
+
+    ESP_LOGI(TAG, "inversions=%u total=%llu us worst=%u us (%s waited on %s, %s ran)",
+             (unsigned)s.episodes, (unsigned long long)s.total_us, (unsigned)s.worst_us,
+             trace_task_name(s.worst.waiter), trace_task_name(s.worst.holder),
+             trace_task_name(s.worst.interferer));
+
+    uint32_t n = (g_hist_n < PIMON_HISTORY) ? g_hist_n : PIMON_HISTORY;
+    for (uint32_t i = 0; i < n; ++i) {
+        const pimon_episode_t *e = &g_hist[(g_hist_n - n + i) % PIMON_HISTORY];
+        ESP_LOGI(TAG, "  #%u: %s blocked by %s, %s ran %u us of a %u us wait",
+                 (unsigned)(g_hist_n - n + i), trace_task_name(e->waiter),
+                 trace_task_name(e->holder), trace_task_name(e->interferer),
+                 (unsigned)e->inverted_us, (unsigned)e->wait_us);
+    }
+    dump_blame();
+}
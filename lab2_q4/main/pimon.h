@@ -0,0 +1,77 @@
+/*
+ * Online priority-inversion monitor for lab2_q4.
+ *
+ * An inversion is time during which a task H waits for a lock held by L while
+ * the CPU runs a third task M with base priority between L's and H's. That
+ * is the window priority inheritance closes, so a mutex(PI) build should
+ * report (almost) nothing while a binsem(noPI) build shows the real cost.
+ *
+ * lockprof feeds lock ownership in; the switch-in hook (FreeRTOSConfig.h,
+ * PIMON_ENABLE) measures who runs. One waiter is tracked per lock.
+ *
+ * Wait blame is broader: every microsecond any task spends waiting for a
+ * lock is charged to (waiter, holder, task on the CPU). Interferer == holder
+ * is the holder's own critical section; any other interferer ran while the
+ * holder was preempted or blocked (IDLE: the holder itself was blocked), and
+ * interferer == waiter is the waiter's own time before it blocked and after
+ * it was woken. Holder is PIMON_NO_HOLDER while the lock was free, e.g.
+ * between a give and the woken waiter's take.
+ */
+
+#ifndef LAB2_PIMON_H
+#define LAB2_PIMON_H
+
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "lab2_config.h"
+
+#define PIMON_MAX_LOCKS     2
+#define PIMON_HISTORY       8       /* most recent episodes kept */
+#define PIMON_BLAME_SLOTS   16      /* distinct (waiter, holder, interferer) kept */
+#define PIMON_NO_HOLDER     0xff
+
+typedef struct {
+    uint8_t  waiter, holder, interferer;    /* trace indices */
+    uint32_t inverted_us;                   /* time M ran while H waited */
+    uint32_t wait_us;                       /* H's whole wait for the lock */
+} pimon_episode_t;
+
+typedef struct {
+    uint32_t episodes;
+    uint32_t worst_us;
+    uint64_t total_us;
+    pimon_episode_t worst;
+} pimon_stats_t;
+
+typedef struct {
+    uint8_t  waiter, holder, interferer;    /* trace indices */
+    uint32_t n;                             /* stretches charged */
+    uint64_t us;
+} pimon_blame_t;
+
+#if PIMON_ENABLE
+/* Called by lockprof */
+void pimon_register(SemaphoreHandle_t h, const char *name);
+void pimon_wait_begin(SemaphoreHandle_t h);     /* about to block on h */
+void pimon_acquired(SemaphoreHandle_t h);       /* calling task now holds h */
+void pimon_released(SemaphoreHandle_t h);       /* calling task is giving h */
+void pimon_wait_cancel(SemaphoreHandle_t h);    /* blocking take timed out */
+#else
+#define pimon_register(h, name)     ((void)0)
+#define pimon_wait_begin(h)         ((void)0)
+#define pimon_acquired(h)           ((void)0)
+#define pimon_released(h)           ((void)0)
+#define pimon_wait_cancel(h)        ((void)0)
+#endif
+
+/* Totals since boot, across all monitored locks */
+void pimon_get_stats(pimon_stats_t *out);
+
+/* Copy up to max blame rows since boot; returns how many */
+int pimon_blame(pimon_blame_t *out, int max);
+
+/* Log totals, worst case, recent episodes and wait blame */
+void pimon_dump(void);
+
+#endif /* LAB2_PIMON_H */
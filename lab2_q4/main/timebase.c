@@ -0,0 +1,65 @@
+#include "freertos/FreeRTOS.h"
+#include "timebase.h"
+
+static uint32_t tb_last;    /* CCOUNT at the previous call */
+static uint32_t tb_hi;      /* number of CCOUNT wraps seen */
+static uint64_t tb_us;      /* microseconds up to tb_last */
+static uint32_t tb_rem;     /* cycles not yet folded into tb_us */
+
+/* Advance the 64-bit state to CCOUNT c; caller has interrupts masked */
+static inline void tb_advance(uint32_t c) {
+    uint32_t d = c - tb_last;   /* mod 2^32: fine for one wrap */
+    if (c < tb_last) tb_hi++;
+    tb_last = c;
+
+    /* 32-bit divide only; a 64-bit one would cost hundreds of cycles here */
+    uint32_t q = d / TIMEBASE_CYCLES_PER_US;
+    tb_rem += d - q * TIMEBASE_CYCLES_PER_US;
+    if (tb_rem >= TIMEBASE_CYCLES_PER_US) {
+        tb_rem -= TIMEBASE_CYCLES_PER_US;
+        q++;
+    }
+    tb_us += q;
+}
+
+/* Raw PS save/restore rather than taskENTER_CRITICAL(): these also run from
+   vTaskSwitchContext() and the trace hooks, where the critical nesting count
+   must not be touched */
+static inline uint32_t tb_lock(void) {
+#ifdef LAB2_HOST
+    return 0;   /* simulated tasks only switch inside kernel calls */
+#else
+    uint32_t ps;
+    __asm__ __volatile__("rsil %0, 15" : "=a"(ps) :: "memory");
+    return ps;
+#endif
+}
+
+static inline void tb_unlock(uint32_t ps) {
+#ifdef LAB2_HOST
+    (void)ps;
+#else
+    __asm__ __volatile__("wsr %0, ps; rsync" :: "a"(ps) : "memory");
+#endif
+}
+
+uint64_t timebase_cycles(void) {
+    uint32_t ps = tb_lock();
+    tb_advance(timebase_ccount());
+    uint64_t cyc = ((uint64_t)tb_hi << 32) | tb_last;
+    tb_unlock(ps);
+    return cyc;
+}
+
+uint64_t timebase_us(void) {
+    uint32_t ps = tb_lock();
+    tb_advance(timebase_ccount());
+    uint64_t us = tb_us;
+    tb_unlock(ps);
+    return us;
+}
+
+/* portGET_RUN_TIME_COUNTER_VALUE() (FreeRTOSConfig.h) */
+uint32_t app_runtime_counter(void) {
+    return (uint32_t)(timebase_cycles() >> TIMEBASE_RTS_SHIFT);
+}
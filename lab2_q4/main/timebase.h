@@ -0,0 +1,44 @@
+/*
+ * Cycle-counter time base for lab2_q4.
+ *
+ * CCOUNT runs at configCPU_CLOCK_HZ and wraps every ~53 s at 80 MHz.
+ * timebase_cycles() / timebase_us() extend it to monotonic 64-bit counts; one
+ * of them must run at least once per wrap period, which the run-time stats
+ * hook (every context switch) and the 1 s status task guarantee.
+ *
+ * Use timebase_us() for every wait/hold/latency measurement: it is a handful
+ * of 32-bit operations with interrupts masked, so trace hooks may call it.
+ */
+
+#ifndef LAB2_TIMEBASE_H
+#define LAB2_TIMEBASE_H
+
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "ccount.h"            /* components/timing */
+
+#define TIMEBASE_CYCLES_PER_US  (configCPU_CLOCK_HZ / 1000000UL)
+
+/* Run-time stats clock = cycles >> TIMEBASE_RTS_SHIFT (5 MHz, wraps ~14 min) */
+#define TIMEBASE_RTS_SHIFT      4
+
+#ifdef LAB2_HOST
+/* Host build (host/sim.c): CCOUNT is simulated time; overhead is measured
+   in real host cycles and charged to simulated time so it still perturbs
+   the schedule */
+uint32_t timebase_ccount(void);
+uint32_t timebase_cost_now(void);
+void     timebase_cost_charge(uint32_t cycles);
+#else
+static inline uint32_t timebase_ccount(void) { return ccount_read(); }
+
+/* Instrumentation overhead accounting: on target the cycles already passed */
+static inline uint32_t timebase_cost_now(void) { return timebase_ccount(); }
+static inline void timebase_cost_charge(uint32_t cycles) { (void)cycles; }
+#endif
+
+/* Monotonic 64-bit counts since boot; callable from any context */
+uint64_t timebase_cycles(void);
+uint64_t timebase_us(void);
+
+#endif /* LAB2_TIMEBASE_H */
@@ -0,0 +1,658 @@
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "trace.h"
+#include "critprof.h"
+#if TRACE_COMPACT
+#include "tracez.h"
+#endif
+
+_Static_assert(sizeof(trace_rec_t) == 12, "trace_rec_t is the raw dump format");
+_Static_assert((TRACE_CAP_SZ & (TRACE_CAP_SZ - 1)) == 0, "capture ring index is masked");
+_Static_assert(TRACE_MAX_TASKS <= 8 && TRACE_EVT_COUNT <= 16, "tracez.h packs task and code in one byte");
+
+/* ===== Double-buffered scheduler trace (FreeRTOSConfig.h hooks) =====
+   Hooks append to the active bank; the status task swaps banks and reads the
+   retired one at leisure. A full bank drops (and counts) new events instead of
+   overwriting unread ones, so every loss is visible to the reader. */
+#if TRACE_COMPACT
+typedef struct {
+    uint32_t fill;              /* bytes written */
+    uint32_t nrec;              /* records */
+    uint32_t lost;              /* events dropped (bank full) */
+    uint32_t sum;               /* store_sum() of data[0..fill), TRACE_PERSIST only */
+    uint8_t  full;              /* a record did not fit: bank closed */
+    tracez_state_t st;          /* encoder state, restarts with the bank */
+    uint8_t  data[TRACE_BANK_BYTES];
+} trace_zbank_t;
+
+/* Everything a later boot needs to decode the banks (see TRACE_PERSIST) */
+typedef struct {
+    uint32_t magic;
+    uint32_t layout;            /* TRACE_STORE_LAYOUT of the build that wrote it */
+    uint32_t ntasks;
+    uint32_t handles[TRACE_MAX_TASKS];
+    char     names[TRACE_MAX_TASKS][configMAX_TASK_NAME_LEN];
+} trace_store_hdr_t;
+
+typedef struct {
+    trace_store_hdr_t hdr;
+    uint32_t check;             /* store_sum() of hdr */
+    uint32_t active;            /* trace_active when it was last written */
+    trace_zbank_t bank[2];
+} trace_store_t;
+
+#if TRACE_PERSIST
+/* Not zeroed at boot: .noinit is NOLOAD in the SDK's dram0 segment. The host
+   build names the section so host/sim.c can carry it over a simulated reset. */
+#ifdef LAB2_HOST
+#define TRACE_NOINIT    __attribute__((section("lab2_noinit")))
+#else
+#define TRACE_NOINIT    __attribute__((section(".noinit")))
+#endif
+#define TRACE_STORE_MAGIC   0x4d505254u     /* "TRPM" */
+#define TRACE_STORE_LAYOUT  ((uint32_t)sizeof(trace_store_t) | (uint32_t)TRACEZ_SHIFT << 24)
+
+static trace_store_t trace_store TRACE_NOINIT;
+static uint8_t trace_store_ready = 0;      /* .bss: 0 until store_boot() ran this boot */
+static int8_t trace_prev = -1;             /* bank the previous run left, -1 = none */
+static trace_store_hdr_t trace_prev_hdr;   /* its task table */
+#else
+static trace_store_t trace_store;
+#endif
+static uint32_t trace_zseeds[TRACE_MAX_TASKS - 1];
+#else
+static trace_rec_t trace_bank[2][TRACE_BANK_SZ];
+static uint32_t trace_fill[2];          /* records written per bank */
+static uint32_t trace_lost[2];          /* events dropped per bank (bank full) */
+#endif
+static volatile uint32_t trace_active = 0;
+static volatile uint32_t trace_seq = 0; /* every hook firing, kept or not */
+static uint32_t trace_lost_total = 0;
+
+/* Bumped by the hook itself, so they stay exact even when a bank fills */
+static uint32_t trace_counts[TRACE_EVT_COUNT];
+
+/* Task index -> name/handle, filled at registration, read only when decoding */
+static const char *trace_tasks[TRACE_MAX_TASKS] = { "?" };
+static TaskHandle_t trace_handles[TRACE_MAX_TASKS];
+static UBaseType_t trace_prios[TRACE_MAX_TASKS];
+static uint8_t trace_ntasks = 1;
+
+#if TRACE_MODE == TRACE_MODE_STRING || TRACE_BENCH
+/* ===== Old snprintf BlockEvt recorder, kept as the overhead baseline ===== */
+typedef struct {
+    uint32_t tick_ms;
+    char     task[8];
+    char     reason[16];
+} BlockEvt;
+
+static volatile uint32_t legacy_idx = 0;
+static BlockEvt legacy_buf[TRACE_BANK_SZ];
+
+static void legacy_trace_record(const char *reason) {
+    uint32_t i = CRITPROF_ATOMIC(__atomic_fetch_add(&legacy_idx, 1, __ATOMIC_RELAXED));
+    BlockEvt *e = &legacy_buf[i % TRACE_BANK_SZ];
+    e->tick_ms = xTaskGetTickCount() * portTICK_PERIOD_MS;
+    snprintf(e->task,   sizeof(e->task),   "%s", pcTaskGetName(NULL));
+    snprintf(e->reason, sizeof(e->reason), "%s", reason);
+}
+#endif
+
+#if TRACE_TRIGGER
+/* ===== Capture ring (see trace.h) =====
+   Written from the same hook contexts as the banks, so the same rule holds:
+   no two writers at once, and a task-level reader excludes them with a
+   critical section. */
+enum { CAP_RUN, CAP_ARMED, CAP_POST, CAP_FROZEN };
+
+static trace_rec_t trace_cap[TRACE_CAP_SZ];
+static trace_rec_t trace_cap_out[TRACE_CAP_SZ];
+static uint32_t trace_cap_n = 0;                /* records written since (re)start */
+static uint32_t trace_cap_trig = 0;             /* trace_cap_n of the trigger record */
+static uint32_t trace_cap_left = 0;             /* post-trigger records still to keep */
+static volatile uint8_t trace_cap_state = CAP_RUN;
+static trace_trigger_t trace_trig;
+
+/* Out of line: only reached when the event code already matches */
+static void __attribute__((noinline)) trigger_check(const trace_rec_t *r, uint32_t value) {
+    if (trace_trig.task && r->task != trace_trig.task) return;
+    if (value < trace_trig.min_value) return;
+
+    trace_cap_trig = trace_cap_n - 1;
+    trace_cap_left = trace_trig.post;
+    trace_cap_state = trace_cap_left ? CAP_POST : CAP_FROZEN;
+}
+
+static inline void capture_record(const trace_rec_t *r, uint32_t value) {
+    uint8_t st = trace_cap_state;
+    if (st == CAP_FROZEN) return;
+
+    trace_cap[trace_cap_n++ & (TRACE_CAP_SZ - 1)] = *r;
+    if (st == CAP_POST) {
+        if (--trace_cap_left == 0) trace_cap_state = CAP_FROZEN;
+    } else if (st == CAP_ARMED && r->code == trace_trig.code) {
+        trigger_check(r, value);
+    }
+}
+#endif
+
+#if TRACE_COMPACT
+/* Running Fletcher-style sum: two 16-bit halves, no modulo */
+static inline uint32_t store_sum(uint32_t sum, const void *p, uint32_t n) {
+    const uint8_t *c = p;
+    uint32_t s1 = sum & 0xffff, s2 = sum >> 16;
+    while (n--) {
+        s1 += *c++;
+        s2 += s1;
+    }
+    return (s2 << 16) | (s1 & 0xffff);
+}
+
+static void bank_reset(uint32_t b) {
+    trace_zbank_t *zb = &trace_store.bank[b];
+    zb->fill = 0;
+    zb->nrec = 0;
+    zb->lost = 0;
+    zb->sum  = 0;
+    zb->full = 0;
+    for (uint8_t t = 1; t < trace_ntasks; ++t)
+        trace_zseeds[t - 1] = (uint32_t)(uintptr_t)trace_handles[t];
+    tracez_reset(&zb->st, trace_zseeds, trace_ntasks - 1);
+}
+
+#if TRACE_PERSIST
+/* First use after boot, from whatever context gets here first (a hook, with
+   interrupts masked or the scheduler suspended, or a caller that masks them):
+   keep the bank the previous run was filling if the store checks out, then
+   start this run's header and bank. A power-on leaves garbage that fails the
+   magic, layout or sums; so does a reset that hit half-way through a record. */
+static void __attribute__((noinline)) store_boot(void) {
+    trace_store_t *st = &trace_store;
+
+    trace_store_ready = 1;
+    if (st->hdr.magic == TRACE_STORE_MAGIC && st->hdr.layout == TRACE_STORE_LAYOUT &&
+        st->check == store_sum(0, &st->hdr, sizeof(st->hdr)) && st->active < 2 &&
+        st->hdr.ntasks <= TRACE_MAX_TASKS) {
+        trace_zbank_t *zb = &st->bank[st->active];
+        if (zb->nrec && zb->fill <= TRACE_BANK_BYTES && zb->st.nseeds < st->hdr.ntasks &&
+            zb->sum == store_sum(0, zb->data, zb->fill)) {
+            trace_prev = (int8_t)st->active;
+            trace_prev_hdr = st->hdr;
+        }
+    }
+
+    memset(&st->hdr, 0, sizeof(st->hdr));
+    st->hdr.magic  = TRACE_STORE_MAGIC;
+    st->hdr.layout = TRACE_STORE_LAYOUT;
+    st->hdr.ntasks = 1;
+    st->check  = store_sum(0, &st->hdr, sizeof(st->hdr));
+    st->active = trace_active = (trace_prev >= 0) ? (uint32_t)trace_prev ^ 1 : 0;
+    bank_reset(trace_active);
+}
+
+static inline void store_ready(void) {
+    if (__builtin_expect(!trace_store_ready, 0)) store_boot();
+}
+#else
+static inline void store_ready(void) {}
+#endif
+
+/* Encode straight into the bank; the hook contexts never overlap (see
+   trace_swap), so the encoder state needs no atomics */
+static inline void bank_append(uint32_t b, const trace_rec_t *r) {
+    trace_zbank_t *zb = &trace_store.bank[b];
+    uint8_t tmp[TRACEZ_MAX_REC];
+    tracez_evt_t e = { r->cycles, r->obj, r->task, r->code, r->arg };
+
+    if (!zb->full) {
+        uint32_t len = tracez_encode(&zb->st, &e, tmp);
+        if (zb->fill + len <= TRACE_BANK_BYTES) {
+            memcpy(&zb->data[zb->fill], tmp, len);
+#if TRACE_PERSIST
+            zb->sum = store_sum(zb->sum, tmp, len);
+#endif
+            zb->fill += len;
+            zb->nrec++;
+            return;
+        }
+        zb->full = 1;
+    }
+    zb->lost++;
+}
+#else
+static inline void bank_append(uint32_t b, const trace_rec_t *r) {
+    uint32_t i = CRITPROF_ATOMIC(__atomic_fetch_add(&trace_fill[b], 1, __ATOMIC_RELAXED));
+    if (i >= TRACE_BANK_SZ) {
+        CRITPROF_ATOMIC(__atomic_fetch_add(&trace_lost[b], 1, __ATOMIC_RELAXED));
+        return;
+    }
+    trace_bank[b][i] = *r;
+}
+
+static inline void store_ready(void) {}
+#endif
+
+static inline void binary_trace_record(uint32_t code, const void *obj, uint8_t arg, uint32_t value) {
+    /* Hot path: no formatting, no name lookups, never blocks */
+    uint32_t s = CRITPROF_ATOMIC(__atomic_fetch_add(&trace_seq, 1, __ATOMIC_RELAXED));
+    trace_rec_t r;
+
+    if (code < TRACE_EVT_COUNT)
+        CRITPROF_ATOMIC(__atomic_fetch_add(&trace_counts[code], 1, __ATOMIC_RELAXED));
+
+    r.cycles = timebase_ccount();
+    r.obj    = (uint32_t)(uintptr_t)obj;
+    r.task   = trace_self_index();     /* < TRACE_MAX_TASKS: tracez packs it in 3 bits */
+    r.code   = (uint8_t)code;
+    r.arg    = arg;
+    r.seq    = (uint8_t)s;
+
+#if TRACE_TRIGGER
+    capture_record(&r, value);
+#else
+    (void)value;
+#endif
+    store_ready();
+    bank_append(trace_active, &r);
+}
+
+#if TRACE_SELF_TIME
+static uint32_t trace_cost_cycles = 0;
+static uint32_t trace_cost_events = 0;
+
+void trace_cost(uint32_t *cycles, uint32_t *events) {
+    *cycles = trace_cost_cycles;
+    *events = trace_cost_events;
+}
+#endif
+
+void app_trace_record(uint32_t code, const void *obj, uint32_t arg) {
+#if TRACE_SELF_TIME
+    uint32_t c0 = timebase_cost_now();
+#endif
+
+#if TRACE_MODE == TRACE_MODE_STRING
+    (void)obj; (void)arg;
+    legacy_trace_record(trace_evt_name((uint8_t)code));
+#else
+    binary_trace_record(code, obj, (uint8_t)arg, arg);
+#endif
+
+#if TRACE_SELF_TIME
+    uint32_t c = timebase_cost_now() - c0;
+    trace_cost_cycles += c;
+    trace_cost_events++;
+    timebase_cost_charge(c);
+#endif
+}
+
+#if TRACE_CAT_LOCK
+void trace_mark(uint32_t code, const void *obj, uint32_t value) {
+    uint8_t bucket = value ? (uint8_t)(32 - __builtin_clz(value)) : 0;
+
+    /* Task context: mask interrupts like the kernel does around its hooks */
+    CRITPROF_ENTER();
+    binary_trace_record(code, obj, bucket, value);
+    CRITPROF_EXIT();
+}
+#endif
+
+void trace_swap(trace_batch_t *out) {
+    /* Every hook runs either with the scheduler suspended (delay/block) or
+       with interrupts masked (switch, take/give, PI), so none can be half-way
+       through a record while this task runs; the critical section only has to
+       make the bank flip itself atomic. */
+    CRITPROF_ENTER();
+    store_ready();
+    uint32_t old = trace_active;
+    uint32_t nxt = old ^ 1;
+#if TRACE_COMPACT
+    bank_reset(nxt);
+#if TRACE_PERSIST
+    trace_prev = -1;            /* unless trace_prev_dump() ran, it is gone now */
+    trace_store.active = nxt;
+#endif
+#else
+    trace_fill[nxt] = 0;
+    trace_lost[nxt] = 0;
+#endif
+    trace_active = nxt;
+    CRITPROF_EXIT();
+
+#if TRACE_COMPACT
+    const trace_zbank_t *zb = &trace_store.bank[old];
+    out->recs   = NULL;
+    out->bytes  = zb->data;
+    out->nbytes = zb->fill;
+    out->nseeds = zb->st.nseeds;
+    out->n      = zb->nrec;
+    out->lost   = zb->lost;
+#else
+    out->recs   = trace_bank[old];
+    out->bytes  = NULL;
+    out->nbytes = 0;
+    out->nseeds = 0;
+    out->n      = (trace_fill[old] < TRACE_BANK_SZ) ? trace_fill[old] : TRACE_BANK_SZ;
+    out->lost   = trace_lost[old];
+#endif
+    trace_lost_total += out->lost;
+    out->lost_total = trace_lost_total;
+}
+
+#define TRACE_RAW_PER_LINE  8                           /* TRC: records per line */
+#define TRACE_Z_PER_LINE    (TRACE_RAW_PER_LINE * 6)        /* TRZ: bytes per line */
+
+static void dump_hex(const char *tag, const uint8_t *p, uint32_t n, uint32_t per_line) {
+    static const char hex[] = "0123456789abcdef";
+    static char line[4 + TRACE_RAW_PER_LINE * sizeof(trace_rec_t) * 2 + 1];
+
+    for (uint32_t i = 0; i < n; i += per_line) {
+        uint32_t cnt = (n - i < per_line) ? n - i : per_line;
+        char *o = line;
+        memcpy(o, tag, 4); o += 4;
+        for (uint32_t k = i; k < i + cnt; ++k) {
+            *o++ = hex[p[k] >> 4];
+            *o++ = hex[p[k] & 0xf];
+        }
+        *o = '\0';
+        puts(line);
+    }
+}
+
+static void dump_batch(const trace_batch_t *b) {
+    if (b->bytes) {
+        printf("TRB:%u,%u\n", (unsigned)b->n, (unsigned)b->nseeds);
+        dump_hex("TRZ:", b->bytes, b->nbytes, TRACE_Z_PER_LINE);
+    } else {
+        dump_hex("TRC:", (const uint8_t *)b->recs, b->n * sizeof(trace_rec_t),
+                 TRACE_RAW_PER_LINE * sizeof(trace_rec_t));
+    }
+    if (b->lost) printf("TRL:%u\n", (unsigned)b->lost);
+}
+
+void trace_dump_tasks(void) {
+    static uint8_t dumped_tasks = 1;
+
+    for (; dumped_tasks < trace_ntasks; ++dumped_tasks)
+        printf("TRT:%u,%08x,%s\n", dumped_tasks,
+               (unsigned)(uintptr_t)trace_handles[dumped_tasks], trace_tasks[dumped_tasks]);
+}
+
+void trace_dump_raw(const trace_batch_t *b) {
+    trace_dump_tasks();
+    dump_batch(b);
+}
+
+#if TRACE_PERSIST
+uint32_t trace_prev_dump(int reason) {
+    CRITPROF_ENTER();
+    store_ready();
+    CRITPROF_EXIT();
+    if (trace_prev < 0) return 0;
+
+    /* Hooks fill the other bank; only trace_swap() would reuse this one */
+    const trace_zbank_t *zb = &trace_store.bank[trace_prev];
+    const trace_store_hdr_t *h = &trace_prev_hdr;
+    trace_batch_t b = { .bytes = zb->data, .nbytes = zb->fill, .nseeds = zb->st.nseeds,
+                        .n = zb->nrec, .lost = zb->lost };
+
+    printf("TRR:%d,%u,%u\n", reason, (unsigned)zb->nrec, (unsigned)zb->lost);
+    for (uint32_t t = 1; t < h->ntasks; ++t)
+        printf("TRT:%u,%08x,%s\n", (unsigned)t, (unsigned)h->handles[t], h->names[t]);
+    dump_batch(&b);
+    trace_prev = -1;
+    return b.n;
+}
+#endif
+
+#if TRACE_TRIGGER
+void trace_trigger_arm(const trace_trigger_t *t) {
+    configASSERT(t->post < TRACE_CAP_SZ);
+    CRITPROF_ENTER();
+    trace_trig = *t;
+    trace_cap_n = 0;
+    trace_cap_state = CAP_ARMED;
+    CRITPROF_EXIT();
+}
+
+int trace_capture_take(trace_capture_t *out) {
+    if (trace_cap_state != CAP_FROZEN) return 0;
+
+    /* Frozen: no hook writes the ring any more, so unroll it at leisure */
+    uint32_t n = (trace_cap_n < TRACE_CAP_SZ) ? trace_cap_n : TRACE_CAP_SZ;
+    uint32_t first = trace_cap_n - n;
+    for (uint32_t k = 0; k < n; ++k)
+        trace_cap_out[k] = trace_cap[(first + k) & (TRACE_CAP_SZ - 1)];
+    out->recs = trace_cap_out;
+    out->n    = n;
+    out->trig = trace_cap_trig - first;
+
+    CRITPROF_ENTER();
+    trace_cap_n = 0;
+    trace_cap_state = CAP_RUN;
+    CRITPROF_EXIT();
+    return 1;
+}
+
+void trace_capture_dump(const trace_capture_t *c) {
+    trace_batch_t b = { .recs = c->recs, .n = c->n };
+    printf("TRG:%u,%u\n", (unsigned)c->trig, (unsigned)c->n);
+    trace_dump_raw(&b);
+}
+#endif
+
+void trace_counts_take(uint32_t counts[TRACE_EVT_COUNT]) {
+    /* Hooks never run while a task sits in a critical section, so this
+       makes copy + reset atomic with respect to them (see trace_swap) */
+    CRITPROF_ENTER();
+    memcpy(counts, trace_counts, sizeof(trace_counts));
+    memset(trace_counts, 0, sizeof(trace_counts));
+    CRITPROF_EXIT();
+}
+
+#if TRACE_PERSIST
+/* Keep the task table next to the banks, so a later boot can name the tasks */
+static void store_task(uint8_t idx, TaskHandle_t task) {
+    trace_store_hdr_t *h = &trace_store.hdr;
+
+    CRITPROF_ENTER();
+    store_ready();
+    h->handles[idx] = (uint32_t)(uintptr_t)task;
+    strncpy(h->names[idx], pcTaskGetName(task), configMAX_TASK_NAME_LEN - 1);
+    h->ntasks = idx + 1u;
+    trace_store.check = store_sum(0, h, sizeof(*h));
+    CRITPROF_EXIT();
+}
+#endif
+
+void trace_register_task(TaskHandle_t task) {
+    if (task == NULL) task = xTaskGetCurrentTaskHandle();
+
+    CRITPROF_SUSPEND_ALL();
+    if (trace_ntasks < TRACE_MAX_TASKS) {
+        trace_tasks[trace_ntasks] = pcTaskGetName(task);
+        trace_handles[trace_ntasks] = task;
+        trace_prios[trace_ntasks] = uxTaskPriorityGet(task);
+        vTaskSetTaskNumber(task, trace_ntasks);
+#if TRACE_PERSIST
+        store_task(trace_ntasks, task);
+#endif
+        trace_ntasks++;
+    }
+    CRITPROF_RESUME_ALL();
+}
+
+uint8_t trace_self_index(void) {
+    UBaseType_t t = uxTaskGetTaskNumber(xTaskGetCurrentTaskHandle());
+    return (t < TRACE_MAX_TASKS) ? (uint8_t)t : 0;
+}
+
+UBaseType_t trace_task_prio(uint8_t task) {
+    return (task < trace_ntasks) ? trace_prios[task] : 0;
+}
+
+const char *trace_task_name(uint8_t task) {
+    return (task < trace_ntasks) ? trace_tasks[task] : "?";
+}
+
+uint8_t trace_task_index(const void *handle) {
+    for (uint8_t t = 1; t < trace_ntasks; ++t)
+        if (trace_handles[t] == handle) return t;
+    return 0;
+}
+
+const char *trace_evt_name(uint8_t code) {
+    switch (code) {
+    case TRACE_EVT_DELAY:        return "DELAY";
+    case TRACE_EVT_DELAY_UNTIL:  return "DELAY_UNTIL";
+    case TRACE_EVT_BLOCK_Q_RECV: return "BLOCK_Q_RECV";
+    case TRACE_EVT_BLOCK_Q_PEEK: return "BLOCK_Q_PEEK";
+    case TRACE_EVT_SWITCH_IN:    return "SWITCH_IN";
+    case TRACE_EVT_SWITCH_OUT:   return "SWITCH_OUT";
+    case TRACE_EVT_TAKE:         return "TAKE";
+    case TRACE_EVT_GIVE:         return "GIVE";
+    case TRACE_EVT_TAKE_RECURSIVE:  return "TAKE_RECURSIVE";
+    case TRACE_EVT_GIVE_RECURSIVE:  return "GIVE_RECURSIVE";
+    case TRACE_EVT_PI_INHERIT:      return "PI_INHERIT";
+    case TRACE_EVT_PI_DISINHERIT:   return "PI_DISINHERIT";
+    case TRACE_EVT_READY:           return "READY";
+    case TRACE_EVT_LOCK_WAIT:       return "LOCK_WAIT";
+    case TRACE_EVT_LOCK_HOLD:       return "LOCK_HOLD";
+    default:                     return "?";
+    }
+}
+
+#if TRACE_BENCH
+/* ===== Hook cost: old snprintf BlockEvt recorder vs binary record ===== */
+#define TRACE_BENCH_ITERS 1000
+
+#if TRACE_COMPACT
+typedef struct {
+    uint32_t seed, cyc;
+    uint8_t  running;       /* task switched in last */
+    uint8_t  switching;     /* SWITCH_OUT done, SWITCH_IN next */
+} bench_gen_t;
+
+/* Next event of a synthetic workload-shaped sequence: mostly close together,
+   sometimes a tick apart; a few objects; small and literal args; switches as
+   the kernel makes them (OUT of the running task, then IN) */
+static void bench_evt(bench_gen_t *g, tracez_evt_t *e) {
+    static const uint8_t codes[] = {
+        TRACE_EVT_SWITCH_OUT, TRACE_EVT_SWITCH_OUT, TRACE_EVT_READY, TRACE_EVT_TAKE,
+        TRACE_EVT_LOCK_WAIT, TRACE_EVT_GIVE, TRACE_EVT_PI_INHERIT, TRACE_EVT_DELAY,
+    };
+    uint32_t r = g->seed = g->seed * 1103515245u + 12345u;
+
+    g->cyc += (r >> 28) ? (r >> 16) & 0xfff : configCPU_CLOCK_HZ / configTICK_RATE_HZ;
+    e->cycles = g->cyc;
+    e->task = g->running;
+    e->code = codes[(r >> 12) & 7];
+    if (g->switching) {
+        e->code = TRACE_EVT_SWITCH_IN;
+        e->task = g->running = (r >> 8) & 7;
+    }
+    g->switching = (e->code == TRACE_EVT_SWITCH_OUT);
+    e->obj = (e->code == TRACE_EVT_SWITCH_IN || e->code == TRACE_EVT_SWITCH_OUT ||
+              e->code == TRACE_EVT_DELAY) ? 0 : 0x3fff0000u + ((r >> 20) & 3) * 0x40;
+    e->arg = (e->code == TRACE_EVT_PI_INHERIT || e->code == TRACE_EVT_LOCK_WAIT) ? (uint8_t)(r >> 4) : 0;
+}
+
+/* Fill the idle bank with bench_evt(), decode it back and compare */
+static void trace_bench_compact(void) {
+    const uint32_t mask = ~((1u << TRACEZ_SHIFT) - 1);
+    uint8_t *buf = trace_store.bank[trace_active ^ 1].data;
+    bench_gen_t g0 = { 1, timebase_ccount(), 0, 0 }, g = g0;
+    tracez_state_t st;
+    tracez_evt_t e, d[2];
+    uint32_t len = 0, n = 0, got = 0, bad = 0, tail = 0;
+
+    tracez_reset(&st, NULL, 0);
+    for (;;) {
+        uint8_t tmp[TRACEZ_MAX_REC];
+        bench_evt(&g, &e);
+        uint32_t l = tracez_encode(&st, &e, tmp);
+        if (len + l > TRACE_BANK_BYTES) break;
+        memcpy(buf + len, tmp, l);
+        len += l;
+        n++;
+        tail = (l == 0);
+    }
+
+    /* An elided SWITCH_OUT comes back with the SWITCH_IN's time; the stream
+       may end on one (tail), which then never comes back */
+    tracez_reset(&st, NULL, 0);
+    g = g0;
+    for (uint32_t off = 0; off < len; ) {
+        uint32_t nd, l = tracez_decode(&st, buf + off, len - off, d, &nd);
+        if (l == 0) { bad++; break; }
+        off += l;
+        for (uint32_t k = 0; k < nd; ++k, ++got) {
+            bench_evt(&g, &e);
+            if (d[k].obj != e.obj || d[k].task != e.task || d[k].code != e.code ||
+                d[k].arg != e.arg || (e.code != TRACE_EVT_SWITCH_OUT && d[k].cycles != (e.cycles & mask)))
+                bad++;
+        }
+    }
+    if (got != n - tail) bad++;
+
+    ESP_LOGI("TRACE", "bench compact: %u events in %u bytes (%u.%02u B/event, BlockEvt 28), round-trip %s",
+             (unsigned)n, (unsigned)len, (unsigned)(len / n), (unsigned)(len % n * 100 / n),
+             bad ? "FAILED" : "ok");
+}
+#endif
+
+void trace_bench(void) {
+    uint32_t leg_min = UINT32_MAX, leg_sum = 0;
+    uint32_t bin_min = UINT32_MAX, bin_sum = 0;
+
+    for (int n = 0; n < TRACE_BENCH_ITERS; ++n) {
+        /* Masked like a hook (see trace_mark()), the stamps inside the
+           window so its own cost stays out of the sample */
+        CRITPROF_ENTER();
+        uint32_t c0 = timebase_ccount();
+        legacy_trace_record("DELAY_UNTIL");
+        uint32_t c1 = timebase_ccount();
+        CRITPROF_EXIT();
+
+        CRITPROF_ENTER();
+        uint32_t c2 = timebase_ccount();
+        binary_trace_record(TRACE_EVT_DELAY_UNTIL, NULL, 0, 0);
+        uint32_t c3 = timebase_ccount();
+        CRITPROF_EXIT();
+
+        /* min filters out samples slowed by a cold cache */
+        if (c1 - c0 < leg_min) leg_min = c1 - c0;
+        if (c3 - c2 < bin_min) bin_min = c3 - c2;
+        leg_sum += c1 - c0;
+        bin_sum += c3 - c2;
+    }
+
+    ESP_LOGI("TRACE", "bench (cycles/hook, n=%d): snprintf min=%u avg=%u | binary min=%u avg=%u",
+             TRACE_BENCH_ITERS,
+             (unsigned)leg_min, (unsigned)(leg_sum / TRACE_BENCH_ITERS),
+             (unsigned)bin_min, (unsigned)(bin_sum / TRACE_BENCH_ITERS));
+#if TRACE_COMPACT
+    trace_bench_compact();
+#endif
+
+    /* Drop the benchmark's records so the run starts with empty banks */
+    trace_seq = 0;
+#if TRACE_COMPACT
+    bank_reset(0);
+    bank_reset(1);
+#if TRACE_PERSIST
+    trace_prev = -1;
+#endif
+#else
+    memset(trace_fill, 0, sizeof(trace_fill));
+    memset(trace_lost, 0, sizeof(trace_lost));
+#endif
+    memset(trace_counts, 0, sizeof(trace_counts));
+#if TRACE_TRIGGER
+    trace_cap_n = 0;
+#endif
+}
+#endif
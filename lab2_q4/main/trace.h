@@ -0,0 +1,172 @@
+/*
+ * Binary block trace for lab2_q4.
+ *
+ * The FreeRTOSConfig.h hooks call app_trace_record() from inside the kernel,
+ * so a record is a fixed-size binary struct appended to one of two banks: no
+ * formatting, no name lookups. Names (task, event) are only resolved when the
+ * ring is decoded.
+ */
+
+#ifndef LAB2_TRACE_H
+#define LAB2_TRACE_H
+
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "lab2_config.h"
+#include "timebase.h"
+
+/* Set to 1 to run trace_bench() once from app_main (string vs binary cost) */
+#ifndef TRACE_BENCH
+#define TRACE_BENCH     0
+#endif
+
+/* Set to 1 to print each retired bank as TRT/TRC/TRL lines for trace2json */
+#ifndef TRACE_DUMP_RAW
+#define TRACE_DUMP_RAW  0
+#endif
+
+/* Set to 1 to account the cycles spent in app_trace_record() (trace_cost) */
+#ifndef TRACE_SELF_TIME
+#define TRACE_SELF_TIME 0
+#endif
+
+/* Set to 0 to drop the triggered capture ring (binary mode only) */
+#ifndef TRACE_TRIGGER
+#define TRACE_TRIGGER   (TRACE_MODE == TRACE_MODE_BINARY)
+#endif
+
+/* Set to 0 to store banks as trace_rec_t arrays instead of tracez.h streams */
+#ifndef TRACE_COMPACT
+#define TRACE_COMPACT   1
+#endif
+
+/* Set to 0 to keep the banks in zeroed RAM. At 1 they sit in .noinit with a
+   checksummed header, so after a warm reset (task WDT, panic, stack overflow)
+   trace_prev_dump() can print what the previous run recorded last */
+#ifndef TRACE_PERSIST
+#define TRACE_PERSIST   (TRACE_COMPACT && TRACE_MODE == TRACE_MODE_BINARY)
+#endif
+#if TRACE_PERSIST && !TRACE_COMPACT
+#error "TRACE_PERSIST needs TRACE_COMPACT"
+#endif
+
+#define TRACE_BANK_SZ   128     /* records per bank; two banks are allocated */
+#define TRACE_BANK_BYTES (TRACE_BANK_SZ * sizeof(trace_rec_t))   /* compact bank: same RAM */
+#define TRACE_CAP_SZ    64      /* capture ring records (power of two) */
+#define TRACE_MAX_TASKS 8       /* index 0 = unregistered task */
+
+/* One hook firing: 12 bytes (was 28 for the string BlockEvt).
+   Layout is also the raw dump format: little-endian, no padding. */
+typedef struct {
+    uint32_t    cycles;   /* CCOUNT at hook entry (80 MHz, wraps every ~53 s) */
+    uint32_t    obj;      /* address of the queue/semaphore/task involved, 0 if none */
+    uint8_t     task;     /* index from trace_register_task() */
+    uint8_t     code;     /* TRACE_EVT_* (lab2_config.h) */
+    uint8_t     arg;      /* event argument (priority for PI events), else 0 */
+    uint8_t     seq;      /* low bits of the hook-firing count; gaps = dropped */
+} trace_rec_t;
+
+/* A retired bank handed to the reader by trace_swap() */
+typedef struct {
+    const trace_rec_t *recs;    /* TRACE_COMPACT = 0, else NULL */
+    const uint8_t *bytes;       /* TRACE_COMPACT = 1: tracez.h stream, else NULL */
+    uint32_t nbytes;
+    uint32_t nseeds;            /* stream dictionary seeded with tasks 1..nseeds */
+    uint32_t n;           /* records in the bank */
+    uint32_t lost;        /* events dropped because the bank was full */
+    uint32_t lost_total;  /* drops since boot */
+} trace_batch_t;
+
+/* Print a batch for the host decoder:
+     TRT:<idx>,<handle>,<name>   task table entry (once per registered task)
+     TRC:<hex>...                up to 8 raw records per line
+     TRB:<n>,<seeds>             compact bank of n records starts (resets the decoder)
+     TRZ:<hex>...                next 48 bytes of the compact stream
+     TRL:<n>                     n events dropped after the records above
+     TRR:<reason>,<n>,<lost>     the previous run's last bank follows, with its
+                                 own TRT lines (trace_prev_dump) */
+void trace_dump_raw(const trace_batch_t *b);
+
+/* Just the TRT lines of tasks registered since the last dump (pcprof.c) */
+void trace_dump_tasks(void);
+
+#if TRACE_PERSIST
+/* If the previous run left a bank that passes the header and checksum tests,
+   print it as TRR, TRT, TRB/TRZ, TRL lines (reason: esp_reset_reason()) and
+   return its record count; 0 after a power-on. Call before trace_bench() and
+   the first trace_swap(), both of which reuse that bank. */
+uint32_t trace_prev_dump(int reason);
+#endif
+
+/* Per-event counters for the status window: copies counts[TRACE_EVT_COUNT]
+   out and zeroes them in one step, so no hook firing is lost or counted twice */
+void trace_counts_take(uint32_t counts[TRACE_EVT_COUNT]);
+
+/* Give a task a small trace index (NULL = calling task) */
+void trace_register_task(TaskHandle_t task);
+
+/* Retire the active bank and start filling the other one. The batch stays
+   valid until the next call; single reader (the status task) only. */
+void trace_swap(trace_batch_t *out);
+
+/* Trace index of the calling task (0 if not registered); safe in hooks */
+uint8_t trace_self_index(void);
+
+/* Base (registration-time) priority of a registered task */
+UBaseType_t trace_task_prio(uint8_t task);
+
+/* Decoding helpers */
+const char *trace_task_name(uint8_t task);
+uint8_t     trace_task_index(const void *handle);   /* 0 if not registered */
+const char *trace_evt_name(uint8_t code);
+
+/* Record an event measured outside the kernel (TRACE_EVT_LOCK_WAIT/HOLD):
+   arg is stored as the log2 bucket of value, triggers see value itself */
+#if TRACE_CAT_LOCK
+void trace_mark(uint32_t code, const void *obj, uint32_t value);
+#else
+#define trace_mark(code, obj, value)    ((void)0)
+#endif
+
+#if TRACE_TRIGGER
+/* ===== Triggered capture =====
+   Besides the banks, every record also goes to a TRACE_CAP_SZ ring that
+   overwrites its oldest entry. Once an armed trigger matches, the ring keeps
+   `post` more records and then freezes, holding the history that led up to
+   the event until trace_capture_take() collects it. */
+typedef struct {
+    uint8_t  code;        /* TRACE_EVT_* that fires it */
+    uint8_t  task;        /* trace index of the recording task, 0 = any */
+    uint16_t post;        /* records kept after the trigger (< TRACE_CAP_SZ) */
+    uint32_t min_value;   /* fire only if value >= this: us for LOCK_WAIT/HOLD,
+                             priority for PI events, 0 = always */
+} trace_trigger_t;
+
+typedef struct {
+    const trace_rec_t *recs;    /* oldest first */
+    uint32_t n;
+    uint32_t trig;              /* recs[trig] is the record that fired */
+} trace_capture_t;
+
+/* Arm (or re-arm) a trigger; the ring restarts empty */
+void trace_trigger_arm(const trace_trigger_t *t);
+
+/* 1 if the ring has frozen: copies it out (valid until the next call) and
+   leaves the trigger disarmed; 0 otherwise */
+int trace_capture_take(trace_capture_t *out);
+
+/* Print a capture for tools/trace2json: TRG:<trig>,<n> then TRT/TRC lines */
+void trace_capture_dump(const trace_capture_t *c);
+#endif
+
+#if TRACE_SELF_TIME
+/* Total cycles spent in hooks and hook firings since boot */
+void trace_cost(uint32_t *cycles, uint32_t *events);
+#endif
+
+#if TRACE_BENCH
+void trace_bench(void);
+#endif
+
+#endif /* LAB2_TRACE_H */
@@ -0,0 +1,110 @@
+#include <string.h>
+#include "tracez.h"
+
+#define TRACEZ_T_MASK   (0xffffffffu >> TRACEZ_SHIFT)
+#define TAG_LITERAL     15
+
+void tracez_reset(tracez_state_t *st, const uint32_t *seeds, uint8_t nseeds) {
+    memset(st, 0, sizeof(*st));
+    if (nseeds > TRACEZ_DICT - 1) nseeds = TRACEZ_DICT - 1;
+    if (nseeds) memcpy(st->objs, seeds, nseeds * sizeof(seeds[0]));
+    st->nseeds = st->next_slot = nseeds;
+}
+
+static void dict_add(tracez_state_t *st, uint32_t obj) {
+    st->objs[st->next_slot] = obj;
+    if (++st->next_slot == TRACEZ_DICT) st->next_slot = st->nseeds;
+}
+
+uint32_t tracez_encode(tracez_state_t *st, const tracez_evt_t *e, uint8_t *out) {
+    uint8_t *o = out;
+
+    if (e->code == TRACEZ_EVT_SWITCH_OUT) {
+        if (st->running == e->task + 1 && !e->obj && !e->arg) return 0;
+        st->running = 0;        /* explicit SWITCH_OUT: next SWITCH_IN stands alone */
+    } else if (e->code == TRACEZ_EVT_SWITCH_IN) {
+        st->running = e->task + 1;
+    }
+
+    uint32_t t = e->cycles >> TRACEZ_SHIFT;
+    uint32_t dt = (t - st->t) & TRACEZ_T_MASK;
+    uint8_t obj_tag = 0, arg_tag;
+
+    st->t = t;
+    if (e->obj) {
+        obj_tag = TAG_LITERAL;
+        for (uint8_t k = 0; k < TRACEZ_DICT; ++k)
+            if (st->objs[k] == e->obj) { obj_tag = k + 1; break; }
+    }
+    arg_tag = (e->arg < TAG_LITERAL) ? e->arg : TAG_LITERAL;
+
+    *o++ = (uint8_t)((e->code & 0x0f) | (e->task & 0x07) << 4 | ((obj_tag | arg_tag) ? 0x80 : 0));
+    if (obj_tag | arg_tag) *o++ = (uint8_t)(obj_tag | arg_tag << 4);
+    do {
+        *o = dt & 0x7f;
+        dt >>= 7;
+        if (dt) *o |= 0x80;
+        o++;
+    } while (dt);
+    if (obj_tag == TAG_LITERAL) {
+        o[0] = (uint8_t)e->obj;
+        o[1] = (uint8_t)(e->obj >> 8);
+        o[2] = (uint8_t)(e->obj >> 16);
+        o[3] = (uint8_t)(e->obj >> 24);
+        o += 4;
+        dict_add(st, e->obj);
+    }
+    if (arg_tag == TAG_LITERAL) *o++ = e->arg;
+    return (uint32_t)(o - out);
+}
+
+uint32_t tracez_decode(tracez_state_t *st, const uint8_t *p, uint32_t n,
+                       tracez_evt_t out[2], uint32_t *nout) {
+    uint32_t i = 0, dt = 0;
+    uint8_t obj_tag = 0, arg_tag = 0;
+    tracez_evt_t *e = out;
+
+    if (n < 2) return 0;
+    uint8_t head = p[i++];
+    if (head & 0x80) {
+        obj_tag = p[i] & 0x0f;
+        arg_tag = p[i] >> 4;
+        i++;
+    }
+    for (int sh = 0;; sh += 7) {
+        if (i >= n || sh > 28) return 0;
+        uint8_t b = p[i++];
+        dt |= (uint32_t)(b & 0x7f) << sh;
+        if (!(b & 0x80)) break;
+    }
+    if (i + (obj_tag == TAG_LITERAL ? 4 : 0) + (arg_tag == TAG_LITERAL ? 1 : 0) > n) return 0;
+
+    st->t = (st->t + dt) & TRACEZ_T_MASK;
+    *nout = 1;
+    if ((head & 0x0f) == TRACEZ_EVT_SWITCH_IN && st->running) {
+        e->cycles = st->t << TRACEZ_SHIFT;
+        e->obj = 0;
+        e->task = st->running - 1;
+        e->code = TRACEZ_EVT_SWITCH_OUT;
+        e->arg = 0;
+        e++;
+        *nout = 2;
+    }
+
+    e->cycles = st->t << TRACEZ_SHIFT;
+    e->code = head & 0x0f;
+    e->task = (head >> 4) & 0x07;
+    e->obj = 0;
+    if (obj_tag == TAG_LITERAL) {
+        e->obj = p[i] | p[i + 1] << 8 | p[i + 2] << 16 | (uint32_t)p[i + 3] << 24;
+        i += 4;
+        dict_add(st, e->obj);
+    } else if (obj_tag) {
+        e->obj = st->objs[obj_tag - 1];
+    }
+    e->arg = (arg_tag == TAG_LITERAL) ? p[i++] : arg_tag;
+
+    if (e->code == TRACEZ_EVT_SWITCH_OUT) st->running = 0;
+    else if (e->code == TRACEZ_EVT_SWITCH_IN) st->running = e->task + 1;
+    return i;
+}
@@ -0,0 +1,75 @@
+/*
+ * Compact trace encoding for lab2_q4 (TRACE_COMPACT).
+ *
+ * A bank becomes a byte stream of variable-length records, 2-4 bytes for a
+ * typical event against 12 for trace_rec_t and 28 for the old BlockEvt:
+ *
+ *   head   code (bits 0-3) | task (bits 4-6) | 0x80 if ext follows
+ *   [ext]  obj tag (bits 0-3) | arg tag (bits 4-7), only if obj or arg != 0
+ *   dt     varint (7 bits per byte, LSB first): timestamp minus the previous
+ *          record's, in units of 2^TRACEZ_SHIFT cycles
+ *   [obj]  4 bytes LE, only for obj tag 15
+ *   [arg]  1 byte, only for arg tag 15
+ *
+ * obj tag 0 = no object, 1..14 = dictionary slot, 15 = new object (literal
+ * follows, then it takes the next free slot round-robin). arg tag 0..14 is
+ * the arg itself. Encoder and decoder keep the same state, reset at the start
+ * of each bank, so every bank decodes on its own. The reset seeds the first
+ * slots with the registered task handles (the objects of READY / PI events),
+ * which the decoder knows from the TRT lines.
+ *
+ * Context switches: vTaskSwitchContext() always fires SWITCH_OUT and then
+ * SWITCH_IN with nothing in between, so once a bank has seen a SWITCH_IN the
+ * running task is known and its SWITCH_OUT is not stored at all. The decoder
+ * re-creates it, stamped with the following SWITCH_IN's time.
+ *
+ * Plain C with no RTOS dependencies: tools/trace2json builds it too.
+ */
+
+#ifndef LAB2_TRACEZ_H
+#define LAB2_TRACEZ_H
+
+#include <stdint.h>
+#include "lab2_config.h"
+
+#define TRACEZ_SHIFT    6       /* timestamp unit: 64 cycles = 0.8 us at 80 MHz;
+                                   a 10 ms tick apart still fits 2 bytes */
+#define TRACEZ_DICT     14      /* object dictionary slots */
+#define TRACEZ_MAX_REC  12      /* longest encoded record */
+#define TRACEZ_EVT_SWITCH_IN    5   /* = TRACE_EVT_SWITCH_IN (lab2_config.h) */
+#define TRACEZ_EVT_SWITCH_OUT   6   /* = TRACE_EVT_SWITCH_OUT */
+
+/* Decoded form; cycles keeps only the bits above TRACEZ_SHIFT */
+typedef struct {
+    uint32_t cycles;
+    uint32_t obj;
+    uint8_t  task;      /* < 8 */
+    uint8_t  code;      /* 1..15 */
+    uint8_t  arg;
+} tracez_evt_t;
+
+typedef struct {
+    uint32_t t;                     /* previous timestamp, in 2^TRACEZ_SHIFT units */
+    uint32_t objs[TRACEZ_DICT];
+    uint8_t  nseeds;                /* slots [0, nseeds) are fixed */
+    uint8_t  next_slot;
+    uint8_t  running;               /* task of the last SWITCH_IN + 1, 0 = unknown */
+} tracez_state_t;
+
+/* Start a bank; seeds[0..nseeds) pre-fill the dictionary (at most
+   TRACEZ_DICT - 1, the rest are ignored) */
+void tracez_reset(tracez_state_t *st, const uint32_t *seeds, uint8_t nseeds);
+
+/* Encode e into out[] (at least TRACEZ_MAX_REC bytes) and advance st.
+   Returns the length, 0 for an elided SWITCH_OUT. A record that then does
+   not fit must end the bank: the decoder never sees it, so nothing encoded
+   after it would decode. */
+uint32_t tracez_encode(tracez_state_t *st, const tracez_evt_t *e, uint8_t *out);
+
+/* Decode one record from p[0..n) into out[0..*nout): one event, or two when
+   an elided SWITCH_OUT comes back in front of a SWITCH_IN. Returns bytes
+   consumed, 0 if p holds only part of a record (or is malformed). */
+uint32_t tracez_decode(tracez_state_t *st, const uint8_t *p, uint32_t n,
+                       tracez_evt_t out[2], uint32_t *nout);
+
+#endif /* LAB2_TRACEZ_H */
@@ -0,0 +1,227 @@
+/*
+ * pcprof: symbolise the lab2_q4 PC samples (PCPROF_ENABLE = 1) against the
+ * build's ELF, print a flat profile and optionally write folded stacks
+ * (flamegraph.pl, speedscope, ui.perfetto.dev).
+ *
+ * Build:  cc -O2 -o pcprof pcprof.c
+ * Usage:  pcprof [-f out.folded] app.elf < serial.log
+ *           app.elf: build/lab2_q4.elf, or host/prof_binary for the host build
+ *
+ * Reads the TRT/PCH/PCP lines out of the log (anything else is ignored; see
+ * main/pcprof.h) and looks each PC up in the ELF's function symbols (ELF32 or
+ * ELF64, little-endian; no binutils needed). A folded stack is
+ * task;function, or task;caller;function when the samples carry a caller.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#define MAX_TASKS   256
+#define SYM_NONE    0xffffffu       /* no symbol / no caller */
+
+typedef struct {
+    uint32_t    addr, size;
+    const char *name;
+} sym_t;
+
+static sym_t   *syms;
+static uint32_t nsyms;
+static char     task_names[MAX_TASKS][24];
+static uint64_t *keys;              /* one per sample: task | caller sym | sym */
+static size_t   nkeys, capkeys;
+static unsigned long n_lost = 0;
+static unsigned rate_hz = 0;
+
+/* ===== ELF symbols ===== */
+
+static uint32_t rd(const uint8_t *p, int n) {
+    uint32_t v = 0;
+    for (int i = n - 1; i >= 0; --i) v = v << 8 | p[i];
+    return v;
+}
+
+static int sym_cmp(const void *a, const void *b) {
+    const sym_t *x = a, *y = b;
+    return (x->addr > y->addr) - (x->addr < y->addr);
+}
+
+static int load_elf(const char *path) {
+    FILE *f = fopen(path, "rb");
+    if (f == NULL) { perror(path); return -1; }
+    fseek(f, 0, SEEK_END);
+    long len = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    uint8_t *elf = malloc((size_t)len);
+    if (elf == NULL || fread(elf, 1, (size_t)len, f) != (size_t)len) { fclose(f); return -1; }
+    fclose(f);
+
+    if (len < 64 || memcmp(elf, "\177ELF", 4) != 0 || elf[5] != 1) {
+        fprintf(stderr, "pcprof: %s: not a little-endian ELF file\n", path);
+        return -1;
+    }
+    int is64 = (elf[4] == 2);
+    uint64_t shoff   = is64 ? (uint64_t)rd(elf + 0x28, 4) | (uint64_t)rd(elf + 0x2c, 4) << 32 : rd(elf + 0x20, 4);
+    uint32_t shentsz = rd(elf + (is64 ? 0x3a : 0x2e), 2);
+    uint32_t shnum   = rd(elf + (is64 ? 0x3c : 0x30), 2);
+
+    for (uint32_t i = 0; i < shnum; ++i) {
+        const uint8_t *sh = elf + shoff + (uint64_t)i * shentsz;
+        if (rd(sh + 4, 4) != 2) continue;                       /* SHT_SYMTAB */
+        uint32_t link  = rd(sh + (is64 ? 0x28 : 0x18), 4);
+        uint64_t off   = rd(sh + (is64 ? 0x18 : 0x10), 4);
+        uint64_t size  = rd(sh + (is64 ? 0x20 : 0x14), 4);
+        uint64_t entsz = rd(sh + (is64 ? 0x38 : 0x24), 4);
+        const uint8_t *strsh = elf + shoff + (uint64_t)link * shentsz;
+        const char *strtab = (const char *)elf + rd(strsh + (is64 ? 0x18 : 0x10), 4);
+
+        syms = calloc(size / entsz, sizeof(sym_t));
+        for (uint64_t k = 0; k < size / entsz; ++k) {
+            const uint8_t *s = elf + off + k * entsz;
+            uint8_t info = s[is64 ? 4 : 12];
+            uint32_t value = rd(s + (is64 ? 8 : 4), 4);
+            if ((info & 0xf) != 2 || value == 0) continue;      /* STT_FUNC */
+            syms[nsyms].addr = value;
+            syms[nsyms].size = rd(s + (is64 ? 16 : 8), 4);
+            syms[nsyms].name = strtab + rd(s, 4);
+            nsyms++;
+        }
+        break;
+    }
+    if (nsyms == 0) {
+        fprintf(stderr, "pcprof: %s: no function symbols (stripped?)\n", path);
+        return -1;
+    }
+    qsort(syms, nsyms, sizeof(sym_t), sym_cmp);
+    return 0;
+}
+
+static uint32_t sym_of(uint32_t pc) {
+    uint32_t lo = 0, hi = nsyms;
+    while (lo < hi) {
+        uint32_t mid = (lo + hi) / 2;
+        if (syms[mid].addr <= pc) lo = mid + 1; else hi = mid;
+    }
+    if (lo == 0) return SYM_NONE;
+    const sym_t *s = &syms[lo - 1];
+    return (s->size == 0 || pc < s->addr + s->size) ? lo - 1 : SYM_NONE;
+}
+
+static const char *sym_name(uint32_t i) {
+    return (i == SYM_NONE) ? "[unknown]" : syms[i].name;
+}
+
+/* ===== Log lines ===== */
+
+static void on_task(const char *s) {
+    unsigned idx, handle;
+    char name[24] = "";
+    if (sscanf(s, "%u,%x,%23[^\r\n]", &idx, &handle, name) < 2 || idx >= MAX_TASKS) return;
+    snprintf(task_names[idx], sizeof(task_names[idx]), "%s", name);
+}
+
+static void on_header(const char *s) {
+    unsigned hz = 0, n = 0, lost = 0;
+    sscanf(s, "%u,%u,%u", &hz, &n, &lost);
+    if (hz) rate_hz = hz;
+    n_lost += lost;
+}
+
+static void on_samples(const char *s) {
+    for (;;) {
+        unsigned task, pc, caller;
+        if (sscanf(s, "%2x%8x%8x", &task, &pc, &caller) != 3) break;
+        s += 18;
+
+        uint32_t c = caller ? sym_of(caller) : SYM_NONE;
+        if (nkeys == capkeys) {
+            capkeys = capkeys ? capkeys * 2 : 4096;
+            keys = realloc(keys, capkeys * sizeof(*keys));
+        }
+        keys[nkeys++] = (uint64_t)(task & 0xff) << 48 | (uint64_t)c << 24 | sym_of(pc);
+    }
+}
+
+/* ===== Reports ===== */
+
+static int key_cmp(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+typedef struct { uint32_t sym; unsigned long n; } flat_t;
+
+static int flat_cmp(const void *a, const void *b) {
+    const flat_t *x = a, *y = b;
+    return (y->n > x->n) - (y->n < x->n);
+}
+
+static const char *task_name(unsigned t) {
+    return task_names[t][0] ? task_names[t] : (t ? "?" : "[unregistered]");
+}
+
+int main(int argc, char **argv) {
+    static char line[4096];
+    const char *folded = NULL, *elf = NULL;
+
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "-f") && i + 1 < argc) folded = argv[++i];
+        else if (elf == NULL && argv[i][0] != '-') elf = argv[i];
+        else elf = NULL, i = argc;
+    }
+    if (elf == NULL) {
+        fprintf(stderr, "usage: %s [-f out.folded] app.elf < serial.log\n", argv[0]);
+        return 2;
+    }
+    if (load_elf(elf) < 0) return 1;
+
+    while (fgets(line, sizeof(line), stdin)) {
+        const char *p;
+        if      ((p = strstr(line, "PCP:"))) on_samples(p + 4);
+        else if ((p = strstr(line, "PCH:"))) on_header(p + 4);
+        else if ((p = strstr(line, "TRT:"))) on_task(p + 4);
+    }
+    if (nkeys == 0) {
+        fprintf(stderr, "pcprof: no PCP samples in the input (PCPROF_ENABLE = 1?)\n");
+        return 1;
+    }
+
+    /* Flat profile: self samples per function */
+    flat_t *flat = calloc(nsyms + 1, sizeof(flat_t));
+    unsigned long per_task[MAX_TASKS] = { 0 };
+    for (uint32_t i = 0; i <= nsyms; ++i) flat[i].sym = (i == nsyms) ? SYM_NONE : i;
+    for (size_t k = 0; k < nkeys; ++k) {
+        uint32_t s = (uint32_t)(keys[k] & SYM_NONE);
+        flat[s == SYM_NONE ? nsyms : s].n++;
+        per_task[keys[k] >> 48]++;
+    }
+    qsort(flat, nsyms + 1, sizeof(flat_t), flat_cmp);
+
+    printf("%zu samples", nkeys);
+    if (rate_hz) printf(" at %u Hz (%.2f s)", rate_hz, (double)nkeys / rate_hz);
+    printf(", %lu lost\n\n  self%%   samples  function\n", n_lost);
+    for (uint32_t i = 0; i <= nsyms && flat[i].n; ++i)
+        printf("%6.2f%% %9lu  %s\n", 100.0 * flat[i].n / nkeys, flat[i].n, sym_name(flat[i].sym));
+    printf("\n  task%%   samples  task\n");
+    for (unsigned t = 0; t < MAX_TASKS; ++t)
+        if (per_task[t])
+            printf("%6.2f%% %9lu  %s\n", 100.0 * per_task[t] / nkeys, per_task[t], task_name(t));
+
+    if (folded) {
+        FILE *f = fopen(folded, "w");
+        if (f == NULL) { perror(folded); return 1; }
+        qsort(keys, nkeys, sizeof(*keys), key_cmp);
+        for (size_t k = 0; k < nkeys; ) {
+            size_t run = k;
+            while (run < nkeys && keys[run] == keys[k]) run++;
+            uint32_t c = (uint32_t)(keys[k] >> 24) & SYM_NONE;
+            fprintf(f, "%s;", task_name((unsigned)(keys[k] >> 48)));
+            if (c != SYM_NONE) fprintf(f, "%s;", sym_name(c));
+            fprintf(f, "%s %zu\n", sym_name((uint32_t)(keys[k] & SYM_NONE)), run - k);
+            k = run;
+        }
+        fclose(f);
+    }
+    return 0;
+}
@@ -0,0 +1,377 @@
+/*
+ * trace2json: decode the lab2_q4 raw trace dump (TRACE_DUMP_RAW = 1) into
+ * Chrome trace-event JSON, viewable in chrome://tracing or ui.perfetto.dev.
+ *
+ * Build:  cc -O2 -I../main -o trace2json trace2json.c ../main/tracez.c
+ * Usage:  trace2json [-m cpu_mhz] < serial.log > run.json
+ *
+ * Reads the TRT/TRC/TRB/TRZ/TRL/TRG/TRR lines out of a captured serial log
+ * (anything else is ignored; TRB/TRZ is the TRACE_COMPACT stream, tracez.h)
+ * and rebuilds, per task, Running / Ready / Blocked intervals from the
+ * SWITCH_IN/OUT, READY and block events. Take/give/PI events become instants
+ * on the task that fired them. Streams in one pass with O(tasks) state.
+ *
+ * A triggered capture (TRG: line, then its records) is decoded the same way,
+ * with a global TRIGGER marker on the record that fired. Feed it on its own
+ * (TRACE_DUMP_RAW = 0): it overlaps in time with any bank dump before it.
+ *
+ * The previous run's bank after a warm reset (TRR: line, TRACE_PERSIST) comes
+ * first in the timeline; a global RESET marker then starts this run's banks
+ * where it ends, since the two runs' CCOUNT values are unrelated.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "tracez.h"
+
+/* Must match main/lab2_config.h */
+enum {
+    EVT_DELAY = 1, EVT_DELAY_UNTIL, EVT_BLOCK_Q_RECV, EVT_BLOCK_Q_PEEK,
+    EVT_SWITCH_IN, EVT_SWITCH_OUT, EVT_TAKE, EVT_GIVE,
+    EVT_TAKE_RECURSIVE, EVT_GIVE_RECURSIVE, EVT_PI_INHERIT, EVT_PI_DISINHERIT,
+    EVT_READY, EVT_LOCK_WAIT, EVT_LOCK_HOLD,
+};
+
+#define MAX_TASKS 256
+#define REC_SZ    12
+
+typedef enum { ST_UNKNOWN, ST_RUNNING, ST_READY, ST_BLOCKED } state_t;
+
+typedef struct {
+    uint32_t handle;
+    char     name[24];
+    state_t  state;
+    uint64_t since;         /* cycles */
+    int      block_pending; /* block event seen while running */
+} task_t;
+
+static task_t   tasks[MAX_TASKS];
+static unsigned ntasks = 1;     /* highest registered index + 1 */
+static unsigned cpu_mhz = 80;
+static uint64_t now;        /* unwrapped cycles */
+static uint32_t last_cyc;
+static int      have_ts = 0;
+static int      first_evt = 1;
+static unsigned long n_recs = 0, n_lost = 0;
+static long     trig_left = -1; /* records until the trigger record, -1 = none */
+static unsigned long n_zbytes = 0;
+static int      prev_run = 0;   /* 1 = TRR seen, 2 = inside its bank */
+static int      reset_reason;
+
+/* Compact stream of the current bank: decoder state + a partial record
+   carried over from the previous TRZ line */
+static tracez_state_t zst;
+static uint8_t  zpend[TRACEZ_MAX_REC + 64];
+static unsigned zpend_n = 0;
+static int      zbank = 0;      /* inside a TRB bank */
+static int      zskip = 0;      /* rest of the bank is undecodable */
+static unsigned long zbank_n, zbank_got;   /* events the TRB line announced, decoded */
+
+static const char *state_name[] = { "?", "Running", "Ready", "Blocked" };
+static const char *state_color[] = { "grey", "good", "yellow", "grey" };
+
+static void emit_sep(void) {
+    if (!first_evt) fputs(",\n", stdout);
+    first_evt = 0;
+}
+
+/* Chrome wants microseconds; print them with ns precision, no floating point */
+static void emit_us(const char *key, uint64_t cyc) {
+    uint64_t ns = cyc * 1000u / cpu_mhz;
+    printf("\"%s\":%llu.%03u", key, (unsigned long long)(ns / 1000), (unsigned)(ns % 1000));
+}
+
+static void set_state(unsigned t, state_t st) {
+    task_t *k = &tasks[t];
+    if (k->state == st) return;
+    if (k->state != ST_UNKNOWN && now > k->since) {
+        emit_sep();
+        printf("{\"name\":\"%s\",\"cname\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,",
+               state_name[k->state], state_color[k->state], t);
+        emit_us("ts", k->since);
+        putchar(',');
+        emit_us("dur", now - k->since);
+        putchar('}');
+    }
+    k->state = st;
+    k->since = now;
+}
+
+static void emit_instant(unsigned t, const char *name, uint32_t obj, int prio) {
+    emit_sep();
+    printf("{\"name\":\"%s\",\"ph\":\"i\",\"s\":\"t\",\"pid\":1,\"tid\":%u,", name, t);
+    emit_us("ts", now);
+    printf(",\"args\":{\"obj\":\"0x%08x\"", (unsigned)obj);
+    if (prio >= 0) printf(",\"prio\":%d", prio);
+    fputs("}}", stdout);
+}
+
+/* LOCK_WAIT/HOLD carry log2(us): show the bucket's upper bound */
+static void emit_duration(unsigned t, const char *name, uint32_t obj, unsigned bucket) {
+    emit_sep();
+    printf("{\"name\":\"%s\",\"ph\":\"i\",\"s\":\"t\",\"pid\":1,\"tid\":%u,", name, t);
+    emit_us("ts", now);
+    printf(",\"args\":{\"obj\":\"0x%08x\",\"us_le\":%lu}}", (unsigned)obj,
+           bucket ? (1ul << bucket) - 1 : 0ul);
+}
+
+static unsigned task_by_handle(uint32_t h) {
+    for (unsigned t = 1; t < ntasks; ++t)
+        if (tasks[t].handle == h) return t;
+    return 0;
+}
+
+static void on_record(const uint8_t *p) {
+    uint32_t cyc  = p[0] | p[1] << 8 | p[2] << 16 | (uint32_t)p[3] << 24;
+    uint32_t obj  = p[4] | p[5] << 8 | p[6] << 16 | (uint32_t)p[7] << 24;
+    unsigned t    = p[8];
+    unsigned code = p[9];
+    unsigned arg  = p[10];
+
+    /* CCOUNT wraps every 2^32 cycles; consecutive events are much closer */
+    if (have_ts) now += (uint32_t)(cyc - last_cyc);
+    last_cyc = cyc;
+    have_ts = 1;
+    n_recs++;
+
+    if (trig_left >= 0 && trig_left-- == 0) {
+        emit_sep();
+        fputs("{\"name\":\"TRIGGER\",\"ph\":\"i\",\"s\":\"g\",\"pid\":1,\"tid\":0,", stdout);
+        emit_us("ts", now);
+        putchar('}');
+    }
+
+    switch (code) {
+    case EVT_SWITCH_IN:
+        tasks[t].block_pending = 0;
+        set_state(t, ST_RUNNING);
+        break;
+    case EVT_SWITCH_OUT:
+        set_state(t, tasks[t].block_pending ? ST_BLOCKED : ST_READY);
+        tasks[t].block_pending = 0;
+        break;
+    case EVT_DELAY:
+    case EVT_DELAY_UNTIL:
+    case EVT_BLOCK_Q_RECV:
+    case EVT_BLOCK_Q_PEEK:
+        tasks[t].block_pending = 1;
+        break;
+    case EVT_READY: {
+        unsigned u = task_by_handle(obj);
+        if (u && tasks[u].state != ST_RUNNING) set_state(u, ST_READY);
+        break;
+    }
+    case EVT_TAKE:           emit_instant(t, "TAKE", obj, -1); break;
+    case EVT_GIVE:           emit_instant(t, "GIVE", obj, -1); break;
+    case EVT_TAKE_RECURSIVE: emit_instant(t, "TAKE_RECURSIVE", obj, -1); break;
+    case EVT_GIVE_RECURSIVE: emit_instant(t, "GIVE_RECURSIVE", obj, -1); break;
+    case EVT_PI_INHERIT:
+        emit_instant(t, "PI_INHERIT", obj, (int)arg);
+        printf(",\n{\"name\":\"boosted by %s\",\"ph\":\"i\",\"s\":\"t\",\"pid\":1,\"tid\":%u,",
+               tasks[t].name[0] ? tasks[t].name : "?", task_by_handle(obj));
+        emit_us("ts", now);
+        putchar('}');
+        break;
+    case EVT_PI_DISINHERIT:
+        emit_instant(t, "PI_DISINHERIT", obj, (int)arg);
+        break;
+    case EVT_LOCK_WAIT: emit_duration(t, "LOCK_WAIT", obj, arg); break;
+    case EVT_LOCK_HOLD: emit_duration(t, "LOCK_HOLD", obj, arg); break;
+    default:
+        break;
+    }
+}
+
+/* Events were dropped on the target: every task's state is now unknown */
+static void on_lost(unsigned long n) {
+    n_lost += n;
+    for (unsigned t = 0; t < MAX_TASKS; ++t) set_state(t, ST_UNKNOWN);
+    emit_sep();
+    printf("{\"name\":\"LOST %lu events\",\"ph\":\"i\",\"s\":\"g\",\"pid\":1,\"tid\":0,", n);
+    emit_us("ts", now);
+    putchar('}');
+}
+
+static void on_task(const char *s) {
+    unsigned idx, handle;
+    char name[24] = "";
+    if (sscanf(s, "%u,%x,%23[^\r\n]", &idx, &handle, name) < 2 || idx >= MAX_TASKS) return;
+    tasks[idx].handle = handle;
+    if (idx >= ntasks) ntasks = idx + 1;
+    snprintf(tasks[idx].name, sizeof(tasks[idx].name), "%s", name);
+    emit_sep();
+    printf("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s\"}}",
+           idx, tasks[idx].name);
+}
+
+static void emit_global(const char *name, int reason) {
+    emit_sep();
+    printf("{\"name\":\"%s\",\"ph\":\"i\",\"s\":\"g\",\"pid\":1,\"tid\":0,", name);
+    emit_us("ts", now);
+    printf(",\"args\":{\"reason\":%d}}", reason);
+}
+
+/* TRR:<reason>,<n>,<lost>: the previous run's last bank follows */
+static void on_reset(const char *s) {
+    reset_reason = atoi(s);
+    prev_run = 1;
+    emit_global("PREVIOUS RUN", reset_reason);
+}
+
+/* The bank's last event may be the running task's elided SWITCH_OUT, which
+   only comes back in front of a SWITCH_IN: one short is fine then */
+static void zbank_end(void) {
+    if (zbank && !zskip &&
+        (zpend_n || !(zbank_got == zbank_n || (zbank_got + 1 == zbank_n && zst.running))))
+        fprintf(stderr, "trace2json: TRZ bank truncated, decoded %lu of %lu events\n",
+                zbank_got, zbank_n);
+    zbank = 0;
+}
+
+/* TRB:<n>,<seeds>: the encoder's dictionary starts with tasks 1..seeds */
+static void on_bank(const char *s) {
+    uint32_t seeds[TRACEZ_DICT];
+    unsigned n = 0, k = 0;
+
+    zbank_end();
+
+    if (prev_run == 2) {
+        /* First bank of this run: restart the clock where the old one ended */
+        for (unsigned t = 0; t < MAX_TASKS; ++t) set_state(t, ST_UNKNOWN);
+        emit_global("RESET", reset_reason);
+        have_ts = 0;
+        prev_run = 0;
+    } else if (prev_run == 1) {
+        prev_run = 2;
+    }
+    zbank_n = strtoul(s, NULL, 10);
+    sscanf(s, "%*u,%u", &n);
+    for (; k < n && k < TRACEZ_DICT && k + 1 < MAX_TASKS; ++k)
+        seeds[k] = tasks[k + 1].handle;
+    tracez_reset(&zst, seeds, (uint8_t)k);
+    zpend_n = 0;
+    zbank_got = 0;
+    zbank = 1;
+    zskip = 0;
+}
+
+static int hexval(int c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+static void on_records(const char *s) {
+    uint8_t rec[REC_SZ];
+    unsigned k = 0;
+    for (;;) {
+        int hi = hexval(s[0]);
+        int lo = (hi < 0) ? -1 : hexval(s[1]);
+        if (lo < 0) break;
+        rec[k++] = (uint8_t)(hi << 4 | lo);
+        s += 2;
+        if (k == REC_SZ) { on_record(rec); k = 0; }
+    }
+}
+
+static void zcorrupt(void) {
+    fprintf(stderr, "trace2json: undecodable TRZ data, skipping to the next bank\n");
+    zskip = 1;
+    zpend_n = 0;
+}
+
+/* Decode every whole record in zpend[]. No record is longer than
+   TRACEZ_MAX_REC, so that many bytes left undecoded means the stream is
+   corrupt: nothing after it can be trusted until the next TRB resets the
+   decoder. */
+static void zdecode(void) {
+    unsigned off = 0;
+    for (;;) {
+        tracez_evt_t ev[2];
+        uint32_t nev, l = tracez_decode(&zst, zpend + off, zpend_n - off, ev, &nev);
+        if (l == 0) break;
+        off += l;
+        zbank_got += nev;
+
+        for (uint32_t k = 0; k < nev; ++k) {
+            const tracez_evt_t *e = &ev[k];
+            uint8_t rec[REC_SZ] = {
+                (uint8_t)e->cycles, (uint8_t)(e->cycles >> 8), (uint8_t)(e->cycles >> 16), (uint8_t)(e->cycles >> 24),
+                (uint8_t)e->obj, (uint8_t)(e->obj >> 8), (uint8_t)(e->obj >> 16), (uint8_t)(e->obj >> 24),
+                e->task, e->code, e->arg, 0,
+            };
+            on_record(rec);
+        }
+    }
+    memmove(zpend, zpend + off, zpend_n - off);
+    zpend_n -= off;
+    if (zpend_n >= TRACEZ_MAX_REC) zcorrupt();
+}
+
+/* A TRZ line is hex bytes up to the end of the line; anything else in it
+   (a garbled UART line) loses bytes mid-stream */
+static void on_zbytes(const char *s) {
+    if (zskip) return;
+    for (;;) {
+        int hi = hexval(s[0]);
+        int lo = (hi < 0) ? -1 : hexval(s[1]);
+        if (lo < 0) break;
+        s += 2;
+        zpend[zpend_n++] = (uint8_t)(hi << 4 | lo);
+        n_zbytes++;
+        if (zpend_n < sizeof(zpend)) continue;
+        zdecode();
+        if (zskip) return;
+    }
+    if (*s && *s != '\r' && *s != '\n') {
+        zcorrupt();
+        return;
+    }
+    zdecode();
+}
+
+int main(int argc, char **argv) {
+    static char line[4096];
+    static char obuf[1 << 16];
+
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "-m") && i + 1 < argc) {
+            cpu_mhz = (unsigned)strtoul(argv[++i], NULL, 10);
+            if (!cpu_mhz) cpu_mhz = 80;
+        } else {
+            fprintf(stderr, "usage: %s [-m cpu_mhz] < serial.log > trace.json\n", argv[0]);
+            return 2;
+        }
+    }
+    setvbuf(stdout, obuf, _IOFBF, sizeof(obuf));
+
+    strcpy(tasks[0].name, "?");
+    fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n", stdout);
+    emit_sep();
+    fputs("{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"lab2_q4\"}}", stdout);
+
+    while (fgets(line, sizeof(line), stdin)) {
+        const char *p;
+        if      ((p = strstr(line, "TRC:"))) on_records(p + 4);
+        else if ((p = strstr(line, "TRZ:"))) on_zbytes(p + 4);
+        else if ((p = strstr(line, "TRB:"))) on_bank(p + 4);
+        else if ((p = strstr(line, "TRT:"))) on_task(p + 4);
+        else if ((p = strstr(line, "TRL:"))) on_lost(strtoul(p + 4, NULL, 10));
+        else if ((p = strstr(line, "TRG:"))) trig_left = (long)strtoul(p + 4, NULL, 10);
+        else if ((p = strstr(line, "TRR:"))) on_reset(p + 4);
+    }
+    zbank_end();
+    for (unsigned t = 0; t < MAX_TASKS; ++t) set_state(t, ST_UNKNOWN);
+
+    fputs("\n]}\n", stdout);
+    fflush(stdout);
+    fprintf(stderr, "trace2json: %lu records, %lu lost, %.3f s of trace\n",
+            n_recs, n_lost, (double)now / (cpu_mhz * 1e6));
+    if (n_zbytes)
+        fprintf(stderr, "trace2json: compact stream %lu bytes, %.2f B/record\n",
+                n_zbytes, n_recs ? (double)n_zbytes / n_recs : 0.0);
+    return 0;
+}
@@ -5,6 +5,11 @@
 #include "freertos/queue.h"
 #include "driver/gpio.h"
 #include "esp_log.h"
+#include "lab2_config.h"
+#include "precise_delay.h"
+#include "stackmon.h"
+#include "stack_sizes.h"
+#include "wcet.h"
 
 #ifndef LED_PIN
 #define LED_PIN 2
@@ -44,8 +49,10 @@ static void task_led_driver(void *arg) {
     (void)arg;
     led_cmd_t cmd;
     ESP_LOGI(TAG, "LED driver started (queue len=1)");
+    int wc = wcet_register("task_led_driver");
 
     for (;;) {
+        wcet_begin(wc);
         if (xQueueReceive(g_ledQ, &cmd, portMAX_DELAY) == pdTRUE) {
             if (cmd == LED_CMD_ON) {
                 led_on();
@@ -55,24 +62,27 @@ static void task_led_driver(void *arg) {
                 ESP_LOGI(TAG, "DRV: LED OFF");
             }
         }
+        wcet_end(wc);
     }
 }
 
-/* T1: send ON, actively wait 0.5 s, yield, then block 1 tick (so lower prios run) */
+/* T1: send ON, wait 0.5 s, yield, then block 1 tick (so lower prios run) */
 static void task_led_on_sender(void *arg) {
     (void)arg;
-    const TickType_t half_sec = pdMS_TO_TICKS(500);
+    const uint32_t half_sec_us = 500 * 1000;
+    int wc = wcet_register("task_led_on_sender");
 
     for (;;) {
+        wcet_begin(wc);
         led_cmd_t cmd = LED_CMD_ON;
         xQueueOverwrite(g_ledQ, &cmd);  /* non-blocking, latest-wins */
-        ESP_LOGI(TAG, "T1: sent LED_CMD_ON, busy-wait 500 ms");
+        ESP_LOGI(TAG, "T1: sent LED_CMD_ON, wait 500 ms");
 
-        TickType_t start = xTaskGetTickCount();
-        while ((xTaskGetTickCount() - start) < half_sec) { /* spin */ }
+        precise_delay_us(half_sec_us);   /* sleeps all but the last tick, then spins */
 
         taskYIELD();
         vTaskDelay(1);
+        wcet_end(wc);
     }
 }
 
@@ -80,36 +90,54 @@ static void task_led_on_sender(void *arg) {
 static void task_led_off_sender(void *arg) {
     (void)arg;
     const TickType_t one_sec = pdMS_TO_TICKS(1000);
+    int wc = wcet_register("task_led_off_sender");
 
     for (;;) {
+        wcet_begin(wc);
         led_cmd_t cmd = LED_CMD_OFF;
         xQueueOverwrite(g_ledQ, &cmd);  /* non-blocking, latest-wins */
         ESP_LOGI(TAG, "T2: sent LED_CMD_OFF (delay 1000 ms)");
         vTaskDelay(one_sec);
+        wcet_end(wc);
     }
 }
 
-/* T3: status every 1 s */
+/* T3: status every 1 s, stack and execution-time reports every 10 s */
 static void task_status(void *arg) {
     (void)arg;
     const TickType_t one_sec = pdMS_TO_TICKS(1000);
+    uint32_t n = 0;
+    int wc = wcet_register("task_status");
     for (;;) {
+        wcet_begin(wc);
         ESP_LOGI(TAG, "T3: tick=%lu", (unsigned long)xTaskGetTickCount());
+        stackmon_sample();
+        if (++n % 10 == 0) {
+            stackmon_report();
+            wcet_report();
+        }
         vTaskDelay(one_sec);
+        wcet_end(wc);
     }
 }
 
 void app_main(void) {
     ESP_LOGI(TAG, "app_main: init (message queue)");
     led_init();
+    precise_delay_init();
 
     /* Single-slot command queue; xQueueOverwrite() requires length 1 */
     g_ledQ = xQueueCreate(1, sizeof(led_cmd_t));
     configASSERT(g_ledQ != NULL);
 
-    /* Start tasks */
-    xTaskCreate(task_led_driver,     "tLED_DRV",  1024, NULL, PRIO_TASK2_LED_OFF+1, NULL);
-    xTaskCreate(task_led_on_sender,  "tLED_ON",   1024, NULL, PRIO_TASK1_LED_ON,    NULL);
-    xTaskCreate(task_led_off_sender, "tLED_OFF",  1024, NULL, PRIO_TASK2_LED_OFF,   NULL);
-    xTaskCreate(task_status,         "tSTATUS",   1024, NULL, PRIO_TASK3_STATUS,    NULL);
+    /* Start tasks (sizes: stack_sizes.h) */
+    TaskHandle_t h;
+    xTaskCreate(task_led_driver,     "tLED_DRV",  STACK_TLED_DRV, NULL, PRIO_TASK2_LED_OFF+1, &h);
+    stackmon_register(h, STACK_TLED_DRV);
+    xTaskCreate(task_led_on_sender,  "tLED_ON",   STACK_TLED_ON,  NULL, PRIO_TASK1_LED_ON,    &h);
+    stackmon_register(h, STACK_TLED_ON);
+    xTaskCreate(task_led_off_sender, "tLED_OFF",  STACK_TLED_OFF, NULL, PRIO_TASK2_LED_OFF,   &h);
+    stackmon_register(h, STACK_TLED_OFF);
+    xTaskCreate(task_status,         "tSTATUS",   STACK_TSTATUS,  NULL, PRIO_TASK3_STATUS,    &h);
+    stackmon_register(h, STACK_TSTATUS);
 }
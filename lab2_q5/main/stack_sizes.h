@@ -0,0 +1,41 @@
+/*
+ * Task stack depths for lab2_q5 (xTaskCreate units: StackType_t).
+ *
+ * By default every task gets STACK_DEFAULT. To right-size them, run once with
+ * the default sizes, let stackmon_report() print its STACKTAB lines (every
+ * 10 s from the status task), then build the table from the log:
+ *
+ *   grep -o 'STACKTAB:.*' serial.log | cut -c10- > main/stack_table.h
+ *
+ * and rebuild with STACK_USE_TABLE = 1. Tasks missing from the table keep
+ * STACK_DEFAULT. Keep stackmon running on the new sizes: a "RAISE IT" line
+ * means a path the first run never took.
+ */
+
+#ifndef LAB2_STACK_SIZES_H
+#define LAB2_STACK_SIZES_H
+
+#ifndef STACK_USE_TABLE
+#define STACK_USE_TABLE 0
+#endif
+
+#define STACK_DEFAULT   1024
+
+#if STACK_USE_TABLE
+#include "stack_table.h"    /* generated, see above */
+#endif
+
+#ifndef STACK_TLED_DRV
+#define STACK_TLED_DRV  STACK_DEFAULT
+#endif
+#ifndef STACK_TLED_ON
+#define STACK_TLED_ON   STACK_DEFAULT
+#endif
+#ifndef STACK_TLED_OFF
+#define STACK_TLED_OFF  STACK_DEFAULT
+#endif
+#ifndef STACK_TSTATUS
+#define STACK_TSTATUS   STACK_DEFAULT
+#endif
+
+#endif /* LAB2_STACK_SIZES_H */
@@ -0,0 +1,85 @@
+#include <stdio.h>
+#include <ctype.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "stackmon.h"
+
+static const char *TAG = "STACK";
+
+typedef struct {
+    TaskHandle_t h;
+    uint32_t     depth;         /* as created, StackType_t units */
+    uint32_t     free_min;      /* lowest high-water mark seen */
+    uint32_t     dropped_s;     /* uptime when free_min last went down */
+} stackmon_task_t;
+
+static stackmon_task_t g_tasks[STACKMON_MAX_TASKS];
+static volatile int g_ntasks = 0;
+
+static uint32_t uptime_s(void) {
+    return xTaskGetTickCount() / configTICK_RATE_HZ;
+}
+
+void stackmon_register(TaskHandle_t task, uint32_t depth) {
+    configASSERT(g_ntasks < STACKMON_MAX_TASKS);
+    stackmon_task_t *t = &g_tasks[g_ntasks];
+    t->h = task;
+    t->depth = depth;
+    t->free_min = depth;
+    t->dropped_s = 0;
+    g_ntasks++;     /* publish last: the status task may be sampling already */
+}
+
+void stackmon_sample(void) {
+    for (int i = 0; i < g_ntasks; ++i) {
+        stackmon_task_t *t = &g_tasks[i];
+        uint32_t f = uxTaskGetStackHighWaterMark(t->h);
+        if (f < t->free_min) {
+            t->free_min = f;
+            t->dropped_s = uptime_s();
+        }
+    }
+}
+
+/* Recommended depth in StackType_t units */
+static uint32_t recommend(const stackmon_task_t *t) {
+    uint32_t used = (t->depth - t->free_min) * sizeof(StackType_t);
+    uint32_t spare = used * STACKMON_MARGIN_PCT / 100;
+    if (spare < STACKMON_MIN_SPARE) spare = STACKMON_MIN_SPARE;
+    uint32_t bytes = (used + spare + 15) & ~15u;
+    return (bytes + sizeof(StackType_t) - 1) / sizeof(StackType_t);
+}
+
+void stackmon_report(void) {
+    uint32_t total = 0, total_rec = 0;
+
+    stackmon_sample();
+    for (int i = 0; i < g_ntasks; ++i) {
+        const stackmon_task_t *t = &g_tasks[i];
+        uint32_t rec = recommend(t);
+        total += t->depth;
+        total_rec += rec;
+        ESP_LOGI(TAG, "%-10s depth=%u used=%u free_min=%u (lowest since %u s) -> %u%s",
+                 pcTaskGetName(t->h), (unsigned)t->depth, (unsigned)(t->depth - t->free_min),
+                 (unsigned)t->free_min, (unsigned)t->dropped_s, (unsigned)rec,
+                 rec > t->depth ? ", RAISE IT" : "");
+    }
+    if (total_rec < total)
+        ESP_LOGI(TAG, "total depth %u -> %u: %u bytes of DRAM back (StackType_t = %u B)",
+                 (unsigned)total, (unsigned)total_rec,
+                 (unsigned)((total - total_rec) * sizeof(StackType_t)), (unsigned)sizeof(StackType_t));
+
+    /* For main/stack_table.h: grep -o 'STACKTAB:.*' log | cut -c10- */
+    printf("STACKTAB:/* stackmon_report() after %u s: used + %d%%, at least %d B spare */\n",
+           (unsigned)uptime_s(), STACKMON_MARGIN_PCT, STACKMON_MIN_SPARE);
+    for (int i = 0; i < g_ntasks; ++i) {
+        const char *s = pcTaskGetName(g_tasks[i].h);
+        char name[configMAX_TASK_NAME_LEN];
+        int k = 0;
+        for (; s[k] && k < (int)sizeof(name) - 1; ++k)
+            name[k] = isalnum((unsigned char)s[k]) ? (char)toupper((unsigned char)s[k]) : '_';
+        name[k] = '\0';
+        printf("STACKTAB:#define STACK_%-16s %u\n", name, (unsigned)recommend(&g_tasks[i]));
+    }
+}
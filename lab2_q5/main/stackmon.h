@@ -0,0 +1,39 @@
+/*
+ * Stack high-water monitor for lab2_q5.
+ *
+ * Samples uxTaskGetStackHighWaterMark() of every registered task, keeps the
+ * lowest free space seen and when it last dropped, and turns that into a
+ * recommended xTaskCreate() depth: used + STACKMON_MARGIN_PCT, at least
+ * STACKMON_MIN_SPARE bytes spare, rounded up to 16 bytes. The report also
+ * prints those sizes as STACKTAB lines, which become main/stack_table.h (see
+ * stack_sizes.h). A high-water mark only covers the paths a task has taken:
+ * run long enough for every branch (and log line) to happen.
+ */
+
+#ifndef LAB2_STACKMON_H
+#define LAB2_STACKMON_H
+
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#ifndef STACKMON_MARGIN_PCT
+#define STACKMON_MARGIN_PCT 25      /* headroom on top of the deepest use seen */
+#endif
+#ifndef STACKMON_MIN_SPARE
+#define STACKMON_MIN_SPARE  128     /* bytes: floor for that headroom */
+#endif
+
+#define STACKMON_MAX_TASKS  8
+
+/* Watch a task; depth as passed to xTaskCreate() (StackType_t units) */
+void stackmon_register(TaskHandle_t task, uint32_t depth);
+
+/* Read every task's high-water mark; cheap enough to call once a second */
+void stackmon_sample(void);
+
+/* Log depth / used / recommended per task, the total DRAM the recommended
+   sizes would give back, then one STACKTAB:#define line per task */
+void stackmon_report(void);
+
+#endif /* LAB2_STACKMON_H */